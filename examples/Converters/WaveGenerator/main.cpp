@@ -14,6 +14,8 @@
 // mcp4728             dac       bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}
 
 // Converter::factory() is use to construct the desired converter object based on the configuration string.
+// The triangle wave is computed once in a table, which is replayed at a fixed sample rate by
+// WaveformPlayer in a real-time thread, the loop() function is free for other tasks.
 
 // This example code is in the public domain.
 #include <Piduino.h>  // All the magic is here ;-)
@@ -33,9 +35,11 @@ constexpr char DacConfig[] = "mcp4728"; // Choose or modify DAC configuration
 // constexpr char DacConfig[] = "mcp4728:ref=int";
 // constexpr char DacConfig[] = "mcp4725";
 constexpr int DacChannel = 0; // Choose DAC channel
+constexpr double SampleRate = 1000; // samples per second
+constexpr size_t WaveLength = 100;  // samples per period, 1000 / 100 = 10 Hz
 
 Converter *dac;
-long min, max, value, inc = 1;
+WaveformPlayer *player;
 
 void setup() {
   Console.begin (115200);
@@ -57,24 +61,33 @@ void setup() {
     }
   }
 
-  min = dac->min();
-  max = dac->max();
-  value = min;
+  // Triangle wave from min to max, computed once
+  std::vector<long> table (WaveLength);
+  long min = dac->min();
+  long max = dac->max();
+  for (size_t i = 0; i < WaveLength; i++) {
+    long step = (2 * (max - min) * static_cast<long> (i)) / static_cast<long> (WaveLength);
+    table[i] = (step <= (max - min)) ? min + step : max - (step - (max - min));
+  }
+
+  player = new WaveformPlayer (dac);
+  player->setTable (DacChannel, table);
+  player->setSampleRate (SampleRate);
+  if (!player->start()) {
+    Console.println ("Failed to start the waveform player!");
+    while (1) {
+      delay (1000);
+    }
+  }
   Console.println ("Setup complete\nCTRL+C to exit");
 }
 
 
 void loop() {
-  // Generate a triangle wave
-  if (value >= max) {
-    inc = -10;
-  }
-  else if (value <= min) {
-    inc = 10;
-  }
-  value += inc;
-  if (!dac->writeChannel (value, DacChannel)) {
-    Console.println ("Failed to write to DAC channel!");
-  }
-  delayMicroseconds (100);
+  // The samples are written by the player thread
+  delay (1000);
+  Console.print ("Rate: ");
+  Console.print (player->achievedRate());
+  Console.print (" Hz, late samples: ");
+  Console.println (player->lateSamples());
 }
@@ -20,8 +20,10 @@
 #include <piduino/mcp4725.h>
 #include <piduino/mcp4728.h>
 #include <piduino/converter.h>
+#include <piduino/waveformplayer.h>
 
 using Converter = Piduino::Converter;
+using WaveformPlayer = Piduino::WaveformPlayer;
 
 using Max1161x = Piduino::Max1161x;
 using Mcp4725 = Piduino::Mcp4725;
@@ -86,6 +86,16 @@ extern HardwareSerial & Serial7;
 class HardwareSerial : public ::Terminal {
 
   public:
+    // PiDuino Extension, Not for Arduino !
+    // The bytes written are stored in an output buffer, written to the port
+    // with a single writev() when the buffer is full, when flush() is called,
+    // and according to the flush policy (combination of the flags below).
+    enum FlushPolicy {
+      FlushExplicit  = 0x00, // only flush() or a full buffer write the buffer
+      FlushOnNewline = 0x01, // the buffer is written at the end of each line
+      FlushOnTimer   = 0x02  // the buffer is written flushTimeout() ms after the first byte stored, not in RS485 modes
+    };
+
     HardwareSerial ();
     explicit HardwareSerial (const Piduino::SerialPort::Info & serialPortInfo);
     explicit HardwareSerial (const String & path);
@@ -101,6 +111,7 @@ class HardwareSerial : public ::Terminal {
     virtual size_t write (uint8_t);
     virtual size_t write (const uint8_t *buffer, size_t size);
     virtual size_t write (const String & str);
+    virtual void flush();
 
     // PiDuino Extension, Not for Arduino !
     void begin (unsigned long baud, const char * portName, uint8_t config = SERIAL_8N1);
@@ -113,6 +124,17 @@ class HardwareSerial : public ::Terminal {
     inline void setWritelnDelay (unsigned long delay);
     inline unsigned long writelnDelay() const;
 
+    void setFlushPolicy (int policy);
+    int flushPolicy() const;
+    void setFlushTimeout (unsigned long ms);
+    unsigned long flushTimeout() const;
+    void setOutputBufferSize (size_t size);
+    size_t outputBufferSize() const;
+    // maximum number of bytes left in the output queue of the driver (TIOCOUTQ)
+    // before writing, the write waits for the queue to drain, 0 for no limit
+    void setMaxPending (size_t bytes);
+    size_t maxPending() const;
+
     inline void setPath (const String & path);
     inline String path() const;
     inline void setPortName (const String & name);
@@ -139,7 +161,16 @@ class HardwareSerial : public ::Terminal {
     inline bool isBreakEnabled() const;
     inline bool setSettings (const Piduino::SerialPort::Settings & settings);
     inline Piduino::SerialPort::Settings settings() const;
+    inline bool setLowLatency (bool enable, int rtPriority = 0);
+    inline bool isLowLatency() const;
+    inline bool setReadThreshold (int bytes);
+    inline int readThreshold() const;
+    inline Piduino::SerialPort::Latency measureLatency (int samples = 100, long msTimeout = 100);
 
+    // Serial, Serial1... Serial7 are bound to the ports of the board on first
+    // use (begin(), path() or portName()): Serial to the default port, the
+    // others to the remaining ports in the order of the enumeration, then to
+    // the default port. setupAvailablePorts() binds all of them at once.
     static void setupAvailablePorts();
     static const int numberOfPorts = 8;
     static std::deque<HardwareSerial> availablePorts;
@@ -150,8 +181,16 @@ class HardwareSerial : public ::Terminal {
     virtual size_t writeln();
 
   private:
+    class TxBuffer;
+    explicit HardwareSerial (int slot);
+    void bind() const;
+    static std::deque<HardwareSerial> createSlots();
+    static Piduino::SerialPort::Info slotPort (int slot);
+
     std::shared_ptr<Piduino::SerialPort> port;
-    unsigned long _writelnDelay; // to avoid buffer overflow on SoC Allwinner
+    std::shared_ptr<TxBuffer> tx;
+    unsigned long _writelnDelay; // fixed delay after each line, 0 by default
+    mutable int _slot; // index in availablePorts until bound, -1 after
 };
 
 inline void HardwareSerial::setWritelnDelay (unsigned long d) {
@@ -161,18 +200,23 @@ inline unsigned long HardwareSerial::writelnDelay() const {
   return _writelnDelay;
 }
 inline void HardwareSerial::setPath (const String & path) {
+  _slot = -1;
   port->setPath (path);
 }
 inline String HardwareSerial::path() const {
+  bind();
   return port->path();
 }
 inline void HardwareSerial::setPortName (const String & name) {
+  _slot = -1;
   port->setPortName (name);
 }
 inline String HardwareSerial::portName() const {
+  bind();
   return port->portName();
 }
 inline void HardwareSerial::setPort (const Piduino::SerialPort::Info & info) {
+  _slot = -1;
   port->setPort (info);
 }
 inline bool HardwareSerial::setBaudRate (int32_t baudRate, Piduino::SerialPort::Directions directions) {
@@ -235,5 +279,20 @@ inline bool HardwareSerial::setSettings (const Piduino::SerialPort::Settings & s
 inline Piduino::SerialPort::Settings HardwareSerial::settings() const {
   return port->settings();
 }
+inline bool HardwareSerial::setLowLatency (bool enable, int rtPriority) {
+  return port->setLowLatency (enable, rtPriority);
+}
+inline bool HardwareSerial::isLowLatency() const {
+  return port->isLowLatency();
+}
+inline bool HardwareSerial::setReadThreshold (int bytes) {
+  return port->setReadThreshold (bytes);
+}
+inline int HardwareSerial::readThreshold() const {
+  return port->readThreshold();
+}
+inline Piduino::SerialPort::Latency HardwareSerial::measureLatency (int samples, long msTimeout) {
+  return port->measureLatency (samples, msTimeout);
+}
 
 #endif
@@ -149,7 +149,6 @@ int main (int __arduino_argc, char ** __arduino_argv) {
 #endif
   CmdLine.parse (argc, argv);
 #endif /* ARDUINO_NOOPTIONS not defined */
-  ::HardwareSerial::setupAvailablePorts();
 #endif /*  __cplusplus defined */
 
   setup();
@@ -18,7 +18,6 @@
 
 #include <piduino/spidev.h>
 #include <Arduino.h>
-#include <mutex>
 
 // SPI_HAS_TRANSACTION means SPI has beginTransaction(), endTransaction(),
 // usingInterrupt(), and SPISetting(clock, bitOrder, dataMode)
@@ -153,7 +152,6 @@ public:
     inline void notUsingInterrupt (uint8_t interruptNumber) {}
 
   private:
-    std::mutex _pendingTransaction;
     Piduino::SpiDev::Info _defaultBus;
 };
 
@@ -53,6 +53,18 @@ class Stream : public Print {
     virtual int timedPeek();    // peek stream with timeout
     int peekNextDigit (LookaheadMode lookahead, bool detectDecimal); // returns the next numeric digit in the stream or -1 if timeout
 
+    // PiDuino Extension, Not for Arduino !
+    // The parsing methods wait with waitForData() then process the received
+    // bytes by blocks. The default implementations rely on available(), read()
+    // and peek() only, a stream with a receive buffer should override them.
+
+    // waits at most msTimeout milliseconds for data, returns true if data is available
+    virtual bool waitForData (unsigned long msTimeout);
+    // copies up to length available bytes without removing them and without waiting
+    virtual size_t peekAvailable (char *buffer, size_t length);
+    // reads up to length available bytes without waiting
+    virtual size_t readAvailable (char *buffer, size_t length);
+
   public:
     Stream() : _timeout (1000) {}
 
@@ -163,6 +175,10 @@ class Stream : public Print {
     // This allows you to search for an arbitrary number of strings.
     // Returns index of the target that is found first or -1 if timeout occurs.
     int findMulti (struct MultiTarget *targets, int tCount);
+
+  private:
+    // feeds c to the search, returns the index of the target found or -1
+    static int matchMulti (struct MultiTarget *targets, int tCount, char c);
 };
 
 #undef NO_IGNORE_CHAR
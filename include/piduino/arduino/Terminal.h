@@ -77,6 +77,9 @@ class Terminal : public Stream {
     virtual Piduino::TerminalNotifier & notifier() = 0;
     virtual int timedRead();    // read stream with timeout
     virtual int timedPeek();    // peek stream with timeout
+    virtual bool waitForData (unsigned long msTimeout);
+    virtual size_t peekAvailable (char *buffer, size_t length);
+    virtual size_t readAvailable (char *buffer, size_t length);
     virtual size_t writeln();
 
     void setReadError (int err = 1) {
@@ -0,0 +1,325 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+
+namespace Piduino {
+
+  /**
+     @class ByteRing
+     @brief Thread safe byte ring buffer with a fixed capacity.
+
+     The bytes are stored in a single contiguous array allocated by the
+     constructor, writes and reads copy whole blocks with memcpy() (at most
+     two segments when the data wraps around the end of the array).
+     The condition variable is only notified when a reader is waiting.
+
+     When the ring is full, write() stores what fits and drops the rest, the
+     number of dropped bytes is given by overruns(), as a UART does when its
+     receive FIFO overflows.
+
+     For a single producer thread and a single consumer thread, the copies
+     can be avoided: the producer fills the free region returned by
+     writeRegion() (e.g. with read(2)) then publishes it with commit(), the
+     consumer processes the bytes in place through views() then releases
+     them with consume().
+  */
+  class ByteRing {
+    public:
+      /**
+         @brief Readable bytes as one or two contiguous segments.
+
+         The second segment is empty unless the data wraps around the end of
+         the array. The pointers stay valid until consume() or clear().
+      */
+      class Views {
+        public:
+          Views() : data {nullptr, nullptr}, size {0, 0} {}
+
+          /**
+             @brief Total number of bytes of the segments.
+          */
+          size_t total() const {
+            return size[0] + size[1];
+          }
+
+          const char *data[2];
+          size_t size[2];
+      };
+
+      /**
+         @brief Constructor
+         @param capacity number of bytes the ring can hold
+      */
+      explicit ByteRing (size_t capacity = 4096) :
+        _buffer (std::max (capacity, static_cast<size_t> (1))), _head (0), _size (0),
+        _overruns (0), _waiters (0) {}
+
+      /**
+         @brief Number of bytes the ring can hold.
+      */
+      size_t capacity() const {
+        return _buffer.size();
+      }
+
+      /**
+         @brief Number of bytes ready to be read.
+      */
+      size_t size() const {
+        std::lock_guard<std::mutex> lock (_mutex);
+        return _size;
+      }
+
+      /**
+         @brief Number of free bytes.
+      */
+      size_t space() const {
+        std::lock_guard<std::mutex> lock (_mutex);
+        return _buffer.size() - _size;
+      }
+
+      /**
+         @brief Number of bytes dropped because the ring was full.
+      */
+      unsigned long overruns() const {
+        std::lock_guard<std::mutex> lock (_mutex);
+        return _overruns;
+      }
+
+      /**
+         @brief Drops all the bytes and clears the overrun counter.
+      */
+      void clear() {
+        std::lock_guard<std::mutex> lock (_mutex);
+        // the free region of the producer does not move
+        _head = (_head + _size) % _buffer.size();
+        _size = 0;
+        _overruns = 0;
+      }
+
+      /**
+         @brief Contiguous free region at the end of the data, producer side.
+
+         The region can be filled without lock, the bytes are only visible
+         to the readers after commit().
+         @param region set to the first free byte
+         @return the size of the region, 0 if the ring is full.
+      */
+      size_t writeRegion (char *&region) {
+        std::lock_guard<std::mutex> lock (_mutex);
+        size_t tail = (_head + _size) % _buffer.size();
+
+        region = &_buffer[tail];
+        return std::min (_buffer.size() - _size, _buffer.size() - tail);
+      }
+
+      /**
+         @brief Publishes \c len bytes written in the region of writeRegion().
+      */
+      void commit (size_t len) {
+        std::lock_guard<std::mutex> lock (_mutex);
+
+        _size += std::min (len, _buffer.size() - _size);
+        if (_waiters) {
+          _cond.notify_all();
+        }
+      }
+
+      /**
+         @brief Readable bytes, consumer side, without copy.
+         @param msTimeout see read()
+      */
+      Views views (long msTimeout = 0) {
+        std::unique_lock<std::mutex> lock (_mutex);
+        Views v;
+
+        waitForData (lock, msTimeout);
+        v.size[0] = std::min (_size, _buffer.size() - _head);
+        v.size[1] = _size - v.size[0];
+        v.data[0] = &_buffer[_head];
+        v.data[1] = &_buffer[0];
+        return v;
+      }
+
+      /**
+         @brief Removes \c len bytes processed through views().
+      */
+      void consume (size_t len) {
+        std::lock_guard<std::mutex> lock (_mutex);
+
+        len = std::min (len, _size);
+        _head = (_head + len) % _buffer.size();
+        _size -= len;
+      }
+
+      /**
+         @brief Writes a block of bytes.
+         @return the number of bytes stored, less than \c len if the ring is full.
+      */
+      size_t write (const char *buf, size_t len) {
+        std::lock_guard<std::mutex> lock (_mutex);
+        size_t n = std::min (len, _buffer.size() - _size);
+
+        if (n) {
+          size_t tail = (_head + _size) % _buffer.size();
+          size_t first = std::min (n, _buffer.size() - tail);
+
+          memcpy (&_buffer[tail], buf, first);
+          memcpy (&_buffer[0], buf + first, n - first);
+          _size += n;
+          if (_waiters) {
+            _cond.notify_all();
+          }
+        }
+        _overruns += len - n;
+        return n;
+      }
+
+      /**
+         @brief Writes a byte.
+         @return false if the ring is full.
+      */
+      bool write (char c) {
+        return write (&c, 1) == 1;
+      }
+
+      /**
+         @brief Reads up to \c max bytes.
+         @param msTimeout 0 returns immediately, -1 waits forever, otherwise
+         waits at most msTimeout milliseconds for the first byte.
+         @return the number of bytes copied to \c buf.
+      */
+      size_t read (char *buf, size_t max, long msTimeout = 0) {
+        std::unique_lock<std::mutex> lock (_mutex);
+
+        waitForData (lock, msTimeout);
+        size_t n = copyOut (buf, max);
+        _head = (_head + n) % _buffer.size();
+        _size -= n;
+        return n;
+      }
+
+      /**
+         @brief Reads a byte.
+         @return false if no byte was available before the timeout.
+      */
+      bool read (char &c, long msTimeout = 0) {
+        return read (&c, 1, msTimeout) == 1;
+      }
+
+      /**
+         @brief Reads all the available bytes.
+         @return the number of bytes appended to \c str.
+      */
+      size_t read (std::string &str, long msTimeout = 0) {
+        std::unique_lock<std::mutex> lock (_mutex);
+
+        waitForData (lock, msTimeout);
+        size_t n = appendTo (str);
+        _head = (_head + n) % _buffer.size();
+        _size -= n;
+        return n;
+      }
+
+      /**
+         @brief Copies up to \c max bytes without removing them.
+         @return the number of bytes copied to \c buf.
+      */
+      size_t peek (char *buf, size_t max, long msTimeout = 0) {
+        std::unique_lock<std::mutex> lock (_mutex);
+
+        waitForData (lock, msTimeout);
+        return copyOut (buf, max);
+      }
+
+      /**
+         @brief Copies the next byte without removing it.
+         @return false if no byte was available before the timeout.
+      */
+      bool peek (char &c, long msTimeout = 0) {
+        return peek (&c, 1, msTimeout) == 1;
+      }
+
+      /**
+         @brief Copies all the available bytes without removing them.
+         @return the number of bytes appended to \c str.
+      */
+      size_t peek (std::string &str, long msTimeout = 0) {
+        std::unique_lock<std::mutex> lock (_mutex);
+
+        waitForData (lock, msTimeout);
+        return appendTo (str);
+      }
+
+    protected:
+      // _mutex must be locked
+      void waitForData (std::unique_lock<std::mutex> &lock, long msTimeout) {
+
+        if (_size == 0 && msTimeout != 0) {
+          auto ready = [this] {
+            return _size != 0;
+          };
+
+          _waiters++;
+          if (msTimeout < 0) {
+
+            _cond.wait (lock, ready);
+          }
+          else {
+
+            _cond.wait_for (lock, std::chrono::milliseconds (msTimeout), ready);
+          }
+          _waiters--;
+        }
+      }
+
+      // _mutex must be locked
+      size_t copyOut (char *buf, size_t max) const {
+        size_t n = std::min (max, _size);
+        size_t first = std::min (n, _buffer.size() - _head);
+
+        memcpy (buf, &_buffer[_head], first);
+        memcpy (buf + first, &_buffer[0], n - first);
+        return n;
+      }
+
+      // _mutex must be locked
+      size_t appendTo (std::string &str) const {
+        size_t first = std::min (_size, _buffer.size() - _head);
+
+        str.append (&_buffer[_head], first);
+        str.append (&_buffer[0], _size - first);
+        return _size;
+      }
+
+      std::vector<char> _buffer;
+      size_t _head; ///< index of the first byte to read
+      size_t _size; ///< number of bytes to read
+      unsigned long _overruns;
+      int _waiters; ///< readers blocked in waitForData()
+      mutable std::mutex _mutex;
+      std::condition_variable _cond;
+  };
+}
+/* ========================================================================== */
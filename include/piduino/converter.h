@@ -22,6 +22,7 @@
 #include <functional>
 #include <piduino/iodevice.h>
 #include <climits>
+#include <cstdint>
 
 namespace Piduino {
   /**
@@ -311,6 +312,35 @@ namespace Piduino {
       */
       virtual long readChannel (int channel = 0, bool differential = false);
 
+      /**
+         @brief Reads the digital values of a range of channels from the converter.
+
+         The default implementation reads the channels one by one with readChannel(),
+         converters with a scan mode read the whole range in a single transaction.
+         @param first The first channel to read.
+         @param last The last channel to read, must be greater than or equal to first.
+         @param values Array of at least last - first + 1 elements receiving the values,
+                values[0] is the value of the first channel.
+         @param differential If true, reads in differential mode (default is false).
+         @return true if all the channels were read, false otherwise.
+      */
+      virtual bool readChannels (int first, int last, long *values, bool differential = false);
+
+      /**
+         @brief Reads a block of successive samples of a channel.
+
+         The default implementation reads the samples one by one with readChannel(),
+         converters with a continuous read mode read several samples per bus transaction
+         without sending the configuration again.
+         @param channel The channel to read from.
+         @param values Array of at least count elements receiving the samples.
+         @param count The number of samples to read.
+         @param differential If true, reads in differential mode (default is false).
+         @return true if all the samples were read, false otherwise.
+         @note This function is disabled if the open mode is not ReadOnly or ReadWrite.
+      */
+      virtual bool readBlock (int channel, long *values, size_t count, bool differential = false);
+
       /**
          @brief Reads a value from the converter (ADC)
          @param channel The channel to read from (default is 0).
@@ -324,7 +354,9 @@ namespace Piduino {
          @param channel The channel to read from (default is 0).
          @param differential If true, reads in differential mode (default is false).
          @param count The number of samples to average (default is 8).
-         @return The average digital value read from the converter.
+         @return The average digital value read from the converter, InvalidValue on error.
+         @note The samples are read by blocks, converters with a repeat mode average
+          several conversions per bus transaction.
       */
       virtual double readAverage (int channel = 0, bool differential = false, int count = 8);
 
@@ -337,6 +369,119 @@ namespace Piduino {
       */
       virtual double readAverageValue (int channel = 0, bool differential = false, int count = 8);
 
+      /**
+         @brief Sample produced by the background acquisition.
+      */
+      struct Sample {
+        int64_t timestamp; ///< Start time of the scan in nanoseconds (CLOCK_MONOTONIC)
+        int channel; ///< Channel number
+        long value; ///< Digital value of the channel
+      };
+
+      /**
+         @brief Statistics of the background acquisition.
+      */
+      struct AcquisitionStats {
+        unsigned long scans; ///< Number of scans performed
+        unsigned long overruns; ///< Number of samples dropped because the stream was full
+        unsigned long missed; ///< Number of periods skipped because a scan was late
+        unsigned long errors; ///< Number of scans that failed
+        double meanJitter; ///< Mean deviation between the scheduled and the actual scan start, in nanoseconds
+        long maxJitter; ///< Maximum deviation between the scheduled and the actual scan start, in nanoseconds
+      };
+
+      /**
+         @brief Handler called by the acquisition thread after each scan.
+         @param samples samples of the scan, one for each channel
+         @param count number of samples
+         @param userData pointer passed to attachStreamHandler()
+      */
+      typedef void (*StreamHandler) (const Sample *samples, int count, void *userData);
+
+      /**
+         @brief Starts the background acquisition.
+
+         A dedicated thread scans the channels from first to last at a fixed rate
+         with readChannels(), so converters with a scan mode read all the channels
+         in a single transaction. The start time of each scan is scheduled on the
+         monotonic clock, the thread sleeps until shortly before the deadline and
+         waits for the remaining time in a busy loop, the margin is calibrated
+         from the measured wake-up latency of the system. The samples are stored
+         with their timestamp in a lock-free ring buffer read by readStream()
+         and passed to the handler attached by attachStreamHandler().
+
+         The acquisition can also be started by open() with the rate=hz and
+         scan=first[-last] options of the parameter string of the factory.
+
+         @param rate scan rate in Hz
+         @param first first channel to scan
+         @param last last channel to scan, must be greater than or equal to first
+         @param capacity minimum number of samples that the stream can hold
+         @return true if the acquisition is started, false if the parameters are
+          invalid or if an acquisition is already running (error EBUSY), it must
+          be stopped first.
+         @note The converter must be opened for reading. While the acquisition
+          is running, the read functions are serialized with the scans.
+      */
+      bool startAcquisition (double rate, int first = 0, int last = 0, int capacity = 4096);
+
+      /**
+         @brief Stops the background acquisition, the samples not read are kept.
+      */
+      void stopAcquisition();
+
+      /**
+         @brief Returns true if the background acquisition is running.
+      */
+      bool isAcquiring() const;
+
+      /**
+         @brief Returns the scan rate of the acquisition in Hz, 0 if none.
+      */
+      double acquisitionRate() const;
+
+      /**
+         @brief Reads the samples of the acquisition.
+
+         This function does not block, the samples are returned in the order of
+         acquisition, the channels of a scan are consecutive.
+         It must not be called by several threads at the same time.
+         @param buffer array receiving the samples
+         @param n size of the array
+         @return number of samples copied to buffer, -1 if no acquisition was started.
+      */
+      int readStream (Sample *buffer, int n);
+
+      /**
+         @brief Number of samples that can be read by readStream().
+      */
+      int streamAvailable() const;
+
+      /**
+         @brief Attaches a handler called by the acquisition thread after each scan.
+
+         The handler is called outside of any lock, it must return quickly to
+         keep the scan rate.
+         @param handler function to call, nullptr to detach
+         @param userData pointer passed to the handler
+      */
+      void attachStreamHandler (StreamHandler handler, void *userData = nullptr);
+
+      /**
+         @brief Detaches the acquisition handler.
+      */
+      void detachStreamHandler();
+
+      /**
+         @brief Returns the statistics of the acquisition.
+      */
+      AcquisitionStats acquisitionStats() const;
+
+      /**
+         @brief Resets the statistics of the acquisition.
+      */
+      void resetAcquisitionStats();
+
       /**
          @brief Writes a digital value to a specific channel of the converter.
          @param value The sample value to write. This value will be clamped to the valid range defined by \c min() and \c max().
@@ -347,6 +492,35 @@ namespace Piduino {
       */
       virtual bool writeChannel (long value, int channel = -1, bool differential = false);
 
+      /**
+         @brief Writes a block of successive samples to a channel.
+
+         The default implementation writes the samples one by one with writeChannel(),
+         at absolute deadlines spaced by period. Converters with a fast write mode
+         send several samples per bus transaction when period is 0.
+         @param channel The channel to write to (-1 for all channels).
+         @param values Array of count samples, each one is clamped to the valid range.
+         @param count The number of samples to write.
+         @param period Interval between two samples in microseconds, 0 (default) to write as fast as possible.
+         @return true if all the samples were written, false otherwise.
+         @note This function is disabled if the open mode is not WriteOnly or ReadWrite.
+      */
+      virtual bool writeBlock (int channel, const long *values, size_t count, unsigned long period = 0);
+
+      /**
+         @brief Writes several channels at once.
+
+         The default implementation calls writeChannel() for each selected channel.
+         Converters with a multi-channel frame (e.g. MCP4728) update all the selected
+         channels in a single bus transaction.
+         @param values Array indexed by channel number, only the selected entries are read,
+          each one is clamped to the valid range.
+         @param mask Selected channels, bit n for channel n (default is all channels).
+         @return true if all the selected channels were written, false otherwise.
+         @note This function is disabled if the open mode is not WriteOnly or ReadWrite.
+      */
+      virtual bool writeChannels (const long *values, unsigned long mask = ~0UL);
+
       /**
          @brief Writes a value to the converter (DAC).
          @param value The value to write, which is converted to a digital value with valueToDigital().
@@ -391,6 +565,21 @@ namespace Piduino {
       */
       virtual long valueToDigital (double value, bool differential = false) const;
 
+      /**
+         @brief Converts an array of digital values to analog values.
+
+         The scaling of the channel is read once and cached until the reference,
+         the full-scale range, the range, the bipolar mode or the mode are changed,
+         then the conversion runs in a tight loop that the compiler can vectorize.
+         The results are the same as those of digitalToValue (int, long, bool).
+         @param digitalValues Array of count digital values.
+         @param values Array of count elements receiving the analog values.
+         @param count The number of values to convert.
+         @param channel The channel number (default is 0).
+         @param differential If true, converts in differential mode (default is false).
+      */
+      virtual void digitalToValue (const long *digitalValues, double *values, size_t count, int channel = 0, bool differential = false) const;
+
       /**
          Converts an analog value to a digital value for a specific channel.
          @param channel The channel number.
@@ -401,6 +590,18 @@ namespace Piduino {
       */
       virtual long valueToDigital (int channel, double value, bool differential = false) const;
 
+      /**
+         @brief Converts an array of analog values to digital values.
+
+         The digital values are clamped to the valid range, see digitalToValue (const long *, double *, size_t, int, bool).
+         @param values Array of count analog values.
+         @param digitalValues Array of count elements receiving the digital values.
+         @param count The number of values to convert.
+         @param channel The channel number (default is 0).
+         @param differential If true, converts in differential mode (default is false).
+      */
+      virtual void valueToDigital (const double *values, long *digitalValues, size_t count, int channel = 0, bool differential = false) const;
+
       /**
          @brief Enables or disables the converter.
          @param enable true to enable, false to disable.
@@ -236,6 +236,22 @@ namespace Piduino {
       */
       virtual bool isActiveLow (const Pin *pin) const;
 
+      /**
+         @brief Gets a direct handle on the data registers of a GPIO pin.
+
+         Allows the time critical code (e.g. software SPI chip select) to
+         drive the pins without the Pin and GpioDevice dispatch, and to
+         drive several pins of the same bank with a single register write.
+
+         The default implementation returns false.
+
+         @param pin Pointer to the Pin object.
+         @param port Filled with the registers and the bit of the pin.
+         @return true if the pin is memory mapped, false otherwise.
+         @note If reimplemented, the hasPortAccess flag must be set.
+      */
+      virtual bool portAccess (const Pin *pin, Pin::Port &port) const;
+
       /**
          @enum Flags
          @brief Flags indicating the capabilities of the GPIO device.
@@ -247,6 +263,7 @@ namespace Piduino {
          - hasWfi: The device supports waiting for interrupts.
          - hasActiveLow: The device supports active low configuration.
          - hasDebounce: The device supports debounce configuration.
+         - hasPortAccess: The device gives a direct access to its data registers.
          - useGpioMem: The device uses /dev/gpiomem for GPIO access.
       */
       enum {
@@ -257,6 +274,7 @@ namespace Piduino {
         hasWfi        = 0x00000010,
         hasActiveLow  = 0x00000020,
         hasDebounce   = 0x00000040,
+        hasPortAccess = 0x00000080,
         useGpioMem    = 0x00010000, ///< Use /dev/gpiomem for GPIO access.
       };
 
@@ -221,6 +221,87 @@ namespace Piduino {
           Pin::Mode mode;  ///< Pin mode for SPI.
       };
 
+      /**
+         @class Port
+         @brief Direct handle on the data registers of the bank of a pin.
+
+         Returned by port() when the pin is memory mapped. It drives the pin,
+         and the other pins of the same bank, by a single register access,
+         without going through Pin and GpioDevice. The handle stays valid as
+         long as the GPIO is open, the pins must already be outputs.
+      */
+      class Port {
+        public:
+          volatile uint32_t *set; ///< writing 1 drives a bit high, nullptr if the bank only has a data register.
+          volatile uint32_t *clr; ///< writing 1 drives a bit low, nullptr if the bank only has a data register.
+          volatile uint32_t *dat; ///< level register, also written by read-modify-write if set is nullptr.
+          uint32_t mask;          ///< bit of the pin in the registers.
+
+          Port() : set (nullptr), clr (nullptr), dat (nullptr), mask (0) {}
+
+          /**
+             @brief Returns true if the handle has been filled by Pin::port().
+          */
+          inline bool isValid() const {
+            return dat != nullptr;
+          }
+
+          /**
+             @brief Returns true if both handles access the same registers.
+          */
+          inline bool sameBank (const Port &other) const {
+            return dat == other.dat;
+          }
+
+          /**
+             @brief Drives the bits of \c bits to \c value.
+          */
+          inline void write (uint32_t bits, bool value) const {
+            if (set) {
+              * (value ? set : clr) = bits;
+            }
+            else {
+              *dat = value ? (*dat | bits) : (*dat & ~bits);
+            }
+          }
+
+          /**
+             @brief Drives the pin to \c value.
+          */
+          inline void write (bool value) const {
+            write (mask, value);
+          }
+
+          /**
+             @brief Drives the bits of \c high high and the bits of \c low low.
+
+             A data register is written once. With set/clear registers, the
+             register of \c first is written first, then the other one.
+          */
+          inline void write (uint32_t high, uint32_t low, bool first) const {
+            if (set) {
+              if (first) {
+                *set = high;
+                *clr = low;
+              }
+              else {
+                *clr = low;
+                *set = high;
+              }
+            }
+            else {
+              *dat = (*dat & ~low) | high;
+            }
+          }
+
+          /**
+             @brief Reads the level of the pin.
+          */
+          inline bool read() const {
+            return (*dat & mask) != 0;
+          }
+      };
+
       /**
          @typedef Event
          @brief Alias for Gpio2::LineEvent, representing a GPIO event.
@@ -449,6 +530,16 @@ namespace Piduino {
       */
       void toggle();
 
+      /**
+         @brief Gets a direct handle on the data registers of the pin.
+
+         Only available for the pins accessed through memory mapping (not
+         through the GPIO character device), see GpioDevice::portAccess().
+         @param port filled with the handle
+         @return True on success, false otherwise.
+      */
+      bool port (Port &port) const;
+
       /**
          @brief Releases the pin, closing any open resources.
       */
@@ -42,6 +42,8 @@ namespace Piduino {
                     This value is automatically set based on the reference voltage for internal and VDD, but may be changed.
     - `bipolar={true|1,false|0}` : If true, enables bipolar mode (default is false).
     - `clk={int,ext}` : The clock setting, either internal or external (default is internal).
+    - `rate=hz` : Starts the background acquisition at this scan rate when the converter is opened (see Converter::startAcquisition()).
+    - `scan=first[-last]` : Channels scanned by the background acquisition (default is 0).
   */
   class Max1161x : public Converter {
 
@@ -79,7 +81,7 @@ namespace Piduino {
       /**
          @brief Constructs a Max1161x object from a string of parameters.
          @param parameters A string containing the parameters for the Max1161x configuration, formatted as
-                "bus=id:max={12,13,14,15,16,17}:ref={ext,vdd,int1,int2,int3,int4}:fsr=value:bipolar={1,0}:clk={int,ext}". \n
+                "bus=id:max={12,13,14,15,16,17}:ref={ext,vdd,int1,int2,int3,int4}:fsr=value:bipolar={1,0}:clk={int,ext}:rate=hz:scan=first-last". \n
                 The parameters for the constructor registered are:
                 - `bus=id` : The I2C bus ID (default is I2cDev::Info::defaultBus().id(), use pinfo to check the default bus ID).
                 - `max={12,13,14,15,16,17}` : The Max1161x model to use, which can be 12, 13, 14, 15, 16, or 17 (default is 15 for Max11615).
@@ -88,6 +90,8 @@ namespace Piduino {
                                 This value is automatically set based on the reference voltage for internal and VDD, but may be changed.
                 - `bipolar={true|1,false|0}` : If true, enables bipolar mode (default is false).
                 - `clk={int,ext}` : The clock setting, either internal or external (default is internal).
+                - `rate=hz` : Starts the background acquisition at this scan rate when the converter is opened.
+                - `scan=first[-last]` : Channels scanned by the background acquisition (default is 0).
          @note This constructor is used for factory registration and must be implemented by subclasses.
       */
       explicit Max1161x (const std::string &parameters);
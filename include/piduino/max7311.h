@@ -21,6 +21,8 @@
 
 namespace Piduino {
 
+  class Pin;
+
   /**
      @brief I2C GPIO expander controller for the MAX7311 device.
 
@@ -63,10 +65,11 @@ namespace Piduino {
          provided as a formatted string. This constructor is primarily used
          by the converter factory system for dynamic object creation.
 
-         @param parameters Configuration string formatted as "bus=id:addr=0x20:bustimeout=1"
+         @param parameters Configuration string formatted as "bus=id:addr=0x20:bustimeout=1:int=pin"
                            - bus: I2C bus number (optional, default: system default)
                            - addr: Device I2C address in hex (optional, default: 0x20)
                            - bustimeout: Enable/disable bus timeout (optional, default: true)
+                           - int: GPIO pin connected to the INT output (optional, see setInterruptPin())
 
          @note This constructor is used for factory registration and dynamic instantiation.
       */
@@ -111,6 +114,96 @@ namespace Piduino {
       */
       bool setBusTimeout (bool enable);
 
+      /**
+         @brief Gets the automatic synchronization setting.
+
+         When enabled (default), each write, toggle or mode change is sent
+         to the device immediately. When disabled, the modifications are only
+         stored in the shadow registers and sent in a single burst by sync(),
+         and readChannel() returns the input state read by the last update().
+
+         @return true if automatic synchronization is enabled
+      */
+      bool autoSync() const;
+
+      /**
+         @brief Enables or disables automatic synchronization.
+
+         Disabling automatic synchronization allows to group several output
+         or mode modifications into one I2C transaction. Re-enabling it sends
+         the pending modifications.
+
+         @param enable true to write each modification immediately
+         @return true on success, false if pending modifications could not be written
+      */
+      bool setAutoSync (bool enable);
+
+      /**
+         @brief Writes the pending modifications to the device.
+
+         Only the modified registers are written, adjacent registers are sent
+         in a single burst.
+
+         @return true on success, false on I2C error
+      */
+      bool sync();
+
+      /**
+         @brief Reads both input ports in a single I2C burst.
+
+         The input state is stored in the shadow registers, it is used by
+         readChannel() while automatic synchronization is disabled.
+
+         @return true on success, false on I2C error
+      */
+      bool update();
+
+      /**
+         @brief Input change handler.
+
+         Called from the interrupt thread after the input ports have been read,
+         once for each input whose state changed.
+
+         @param channel channel number (0 to 15)
+         @param value new state of the input
+         @param userData pointer passed to attachChangeHandler()
+      */
+      typedef void (*ChangeHandler) (int channel, bool value, void *userData);
+
+      /**
+         @brief Sets the native pin connected to the INT output of the expander.
+
+         When an interrupt pin is set, a falling edge on INT triggers a single
+         burst read of both input ports, the input state is stored in the shadow
+         registers and the change handlers are called. read() and readChannel()
+         then return the stored state without any I2C transaction.
+         The pin can also be given in the parameter string of the factory (int=pin).
+
+         @param pin GPIO pin connected to INT (open drain, active low), nullptr
+         to go back to polling.
+         @return true on success, false if the interrupt could not be attached.
+      */
+      bool setInterruptPin (Pin *pin);
+
+      /**
+         @brief Returns the pin connected to the INT output, nullptr if none.
+      */
+      Pin *interruptPin() const;
+
+      /**
+         @brief Attaches an input change handler.
+         @param handler function to call
+         @param channel input channel, -1 for all channels
+         @param userData pointer passed to the handler
+      */
+      void attachChangeHandler (ChangeHandler handler, int channel = -1, void *userData = nullptr);
+
+      /**
+         @brief Detaches the input change handler.
+         @param channel input channel, -1 for all channels
+      */
+      void detachChangeHandler (int channel = -1);
+
     protected:
       /**
          @brief Forward declaration of the private implementation class.
@@ -0,0 +1,186 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <piduino/gpiodevice.h>
+#include <piduino/max7311.h>
+
+namespace Piduino {
+
+  /**
+     @class Max7311Gpio
+     @brief GpioDevice backed by a MAX7311 I2C port expander.
+
+     The 16 I/O lines of the expander are handled as GPIO lines numbered from 0
+     to 15 and are accessed by their number with the line API below.
+
+     The Pin overloads of the GpioDevice interface take the line from the MCU
+     number of the pin (Pin::mcuNumber()). They are only called for pins of a
+     connector built on this device, the board database does not describe such
+     connectors yet, so the pins of Gpio can not be bound to the expander.
+     Its registers are not memory mapped, there is no Pin::Port fast path.
+
+     Output and configuration writes go to the shadow registers of the Max7311.
+     Outside of a batch each modification is sent immediately (only if the register
+     changes), inside a batch they are sent in a single I2C transaction by endBatch()
+     or sync(). Inputs are read with a single 2-byte burst, inside a batch
+     the value read by the last update() is returned.
+
+     @code
+     Max7311Gpio relays (1, 0x20);
+
+     relays.open();
+     relays.beginBatch();
+     for (int line = 0; line < 12; line++) {
+       relays.write (line, state[line]);
+     }
+     relays.endBatch(); // one I2C transaction for all the outputs
+     @endcode
+
+     This class may be used as a model for other I2C or SPI port expanders.
+  */
+  class Max7311Gpio : public GpioDevice {
+
+    public:
+      /**
+         @brief Constructs a device and its Max7311 expander.
+         @param busId The I2C bus identifier
+         @param address The 7-bit I2C device address
+      */
+      Max7311Gpio (int busId = I2cDev::Info::defaultBus().id(), int address = 0x20);
+
+      /**
+         @brief Constructs a device on an existing Max7311 expander.
+         @param expander pointer on the expander, it is not owned by the device
+         and must remain valid during the life of the device.
+      */
+      explicit Max7311Gpio (Max7311 *expander);
+
+      /**
+         @brief Destructor
+      */
+      virtual ~Max7311Gpio();
+
+      // Mandatory API
+      // ----------------------------------------------------------------
+      virtual bool open() override;
+      virtual void close() override;
+      virtual AccessLayer preferedAccessLayer() const override;
+      virtual unsigned int flags() const override;
+      virtual void setMode (const Pin *pin, Pin::Mode m) override;
+      virtual Pin::Mode mode (const Pin *pin) const override;
+      virtual void write (const Pin *pin, bool v) override;
+      virtual bool read (const Pin *pin) const override;
+      virtual void setPull (const Pin *pin, Pin::Pull p) override;
+      virtual const std::map<Pin::Mode, std::string> &modes() const override;
+
+      // Optional API
+      // ----------------------------------------------------------------
+      virtual void toggle (const Pin *pin) override;
+      virtual Pin::Pull pull (const Pin *pin) const override;
+      virtual void setActiveLow (const Pin *pin, bool activeLow) override;
+      virtual bool isActiveLow (const Pin *pin) const override;
+
+      // Line API
+      // ----------------------------------------------------------------
+      /**
+         @brief Number of lines of the device
+      */
+      static const int NumberOfLines = 16;
+
+      /**
+         @brief Sets the mode of a line, only ModeInput and ModeOutput are supported.
+      */
+      void setMode (int line, Pin::Mode m);
+
+      /**
+         @brief Gets the mode of a line.
+      */
+      Pin::Mode mode (int line) const;
+
+      /**
+         @brief Writes a line.
+      */
+      void write (int line, bool v);
+
+      /**
+         @brief Reads a line.
+      */
+      bool read (int line) const;
+
+      /**
+         @brief Toggles a line.
+      */
+      void toggle (int line);
+
+      /**
+         @brief Writes all the output lines at once, bit n for line n.
+      */
+      void writeAll (uint16_t values);
+
+      /**
+         @brief Reads all the lines at once (single burst read), bit n for line n.
+      */
+      uint16_t readAll() const;
+
+      // Batch API
+      // ----------------------------------------------------------------
+      /**
+         @brief Starts a batch, the modifications are kept in the shadow registers.
+
+         The input state is refreshed with one burst read, it is returned by read()
+         until the end of the batch or the next update().
+      */
+      void beginBatch();
+
+      /**
+         @brief Ends a batch, the modifications are sent in a single transaction.
+         @throw std::system_error on I2C error
+      */
+      void endBatch();
+
+      /**
+         @brief Returns true if a batch is in progress.
+      */
+      bool isBatch() const;
+
+      /**
+         @brief Sends the pending modifications without ending the batch.
+         @throw std::system_error on I2C error
+      */
+      void sync();
+
+      /**
+         @brief Refreshes the input state with one 2-byte burst read.
+         @throw std::system_error on I2C error
+      */
+      void update();
+
+      /**
+         @brief Returns the underlying expander.
+      */
+      Max7311 *expander() const;
+
+    protected:
+      class Private;
+      Max7311Gpio (Private &dd);
+
+    private:
+      PIMP_DECLARE_PRIVATE (Max7311Gpio)
+  };
+}
+/* ========================================================================== */
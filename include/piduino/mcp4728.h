@@ -22,6 +22,8 @@
 
 namespace Piduino {
 
+  class Pin;
+
   /**
      @class Mcp4728
      @brief Class for the MCP4728 series of digital-to-analog converters.
@@ -38,6 +40,7 @@ namespace Piduino {
      - `fsr=value` : The full-scale range value. (default is 3.3V)
      - `gain={1,2}` : The gain setting (default is 1).
      - `mode={norm,fast,eeprom,pd1k,pd100k,pd500k}` : The mode setting (default is norm). See the MCP4728 datasheet for more information.
+     - `ldac=pin` : GPIO pin connected to the LDAC input (optional, see setLdacPin()).
   */
   class Mcp4728 : public Converter {
 
@@ -76,12 +79,13 @@ namespace Piduino {
          by the converter factory system for dynamic object creation.
 
          @param parameters A string containing the parameters for the Mcp4728 configuration, formatted as
-                           "bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}". \n
+                           "bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}:ldac=pin". \n
                            The parameters for the constructor registered are:
                            - `bus=id` : The I2C bus ID (default is I2cDev::Info::defaultBus().id(), use pinfo to check the default bus ID).
                            - `addr={0x60..0x67}` : The I2C address of the converter (default is 0x60).
                            - `fsr=value` : The full-scale range value. (default is 3.3V).
                            - `mode={norm,eeprom,pd1k,pd100k,pd500k}` : The mode setting (default is norm). See the MCP4728 datasheet for more information.
+                           - `ldac=pin` : GPIO pin connected to the LDAC input (optional).
 
          @note This constructor is used for factory registration and must be implemented by subclasses.
       */
@@ -189,6 +193,38 @@ namespace Piduino {
         return fastWrite (values.data());
       }
 
+      /**
+         @fn virtual bool writeChannels (const long *values, unsigned long mask = ~0UL)
+         @brief Writes several channels in a single fast write frame.
+
+         The channels that are not selected by mask keep their current value.
+         If a LDAC pin is set, LDAC is held high during the frame and the four
+         outputs are updated together on its falling edge, otherwise each output
+         is updated as soon as its two bytes are received.
+         If one of the selected channels is in SaveToEEPROM mode, the channels are
+         written one by one because the fast write command does not program the EEPROM.
+         @param values Array of 4 values indexed by channel number.
+         @param mask Selected channels, bit n for channel n (default is all channels).
+         @return true if successful, false otherwise.
+      */
+
+      /**
+         @brief Sets the native pin connected to the LDAC input of the DAC.
+
+         The pin is set as an output at low level when the converter is opened, so
+         that the writes that do not use it update the outputs immediately.
+         writeChannels() pulses it to update all the channels synchronously.
+         The pin can also be given in the parameter string of the factory (ldac=pin).
+         @param pin GPIO pin connected to LDAC, nullptr if LDAC is tied to ground.
+         @return true on success, false if the pin could not be set as output.
+      */
+      bool setLdacPin (Pin *pin);
+
+      /**
+         @brief Returns the pin connected to the LDAC input, nullptr if none.
+      */
+      Pin *ldacPin() const;
+
 
     protected:
       /**
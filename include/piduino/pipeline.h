@@ -0,0 +1,402 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <atomic>
+#include <piduino/global.h>
+#include <piduino/converter.h>
+#include <piduino/spscring.h>
+
+namespace Piduino {
+
+  /**
+     @class Pipeline
+     @brief Acquisition, filtering and publishing chain built on the converters.
+
+     The source is a converter running a background acquisition
+     (Converter::startAcquisition()). The samples of the acquisition stream are
+     converted to analog values by blocks, processed in place by the stages,
+     then sent to the sinks. All the buffers are allocated by start(), the
+     stages and the sinks process a whole block of a channel with a single
+     virtual call.
+
+     The stages and the sinks can be created from spec strings, in the same
+     way as the converters:
+     | **Spec**              | **Stage or sink**                               |
+     |-----------------------|-------------------------------------------------|
+     | `avg:n=8`             | MovingAverage on 8 samples                      |
+     | `lowpass:fc=10`       | LowPass, first order IIR, cut-off 10 Hz         |
+     | `decim:n=4`           | Decimator, keeps 1 sample out of 4              |
+     | `min:n=100`           | Window, minimum of 100 samples                  |
+     | `max:n=100`           | Window, maximum of 100 samples                  |
+     | `mean:n=100`          | Window, mean of 100 samples                     |
+     | `rms:n=100`           | Window, RMS value of 100 samples                |
+     | `ring:size=4096`      | RingSink holding 4096 frames                    |
+     | `csv:file=path`       | FileSink, one text line per frame               |
+     | `bin:file=path`       | FileSink, raw doubles, frame after frame        |
+     | `dac:<converter spec>`| ConverterSink, e.g. `dac:mcp4728:ref=int`       |
+
+     @code
+     Pipeline pipe ("max1161x:bus=1:id=max11615", 0, 3);
+
+     pipe.addStage ("lowpass:fc=5");
+     pipe.addStage ("decim:n=10");
+     pipe.addSink ("csv:file=/tmp/ain.csv");
+     pipe.start (1000); // 1000 scans/s in, 100 frames/s out
+     @endcode
+  */
+  class Pipeline {
+    public:
+
+      /**
+         @brief Processing stage, all the channels share the same stage object.
+      */
+      class Stage {
+        public:
+          virtual ~Stage() {}
+
+          /**
+             @brief Allocates the state of the stage, called by Pipeline::start().
+             @param channels number of channels
+             @param rate input sample rate of the stage in Hz
+          */
+          virtual void prepare (int /*channels*/, double /*rate*/) {}
+
+          /**
+             @brief Processes a block of a channel in place.
+             @param channel channel index, from 0 to channels - 1
+             @param data samples of the channel
+             @param count number of samples in data
+             @return number of output samples, stored at the beginning of data.
+             It must be the same for all the channels of a block.
+          */
+          virtual size_t process (int channel, double *data, size_t count) = 0;
+
+          /**
+             @brief Output sample rate for a given input rate.
+          */
+          virtual double outputRate (double rate) const {
+            return rate;
+          }
+
+          /**
+             @brief Clears the state of the stage.
+          */
+          virtual void reset() {}
+      };
+
+      /**
+         @brief Moving average on n samples.
+      */
+      class MovingAverage : public Stage {
+        public:
+          explicit MovingAverage (size_t n);
+          virtual void prepare (int channels, double rate) override;
+          virtual size_t process (int channel, double *data, size_t count) override;
+          virtual void reset() override;
+
+        private:
+          size_t m_n;
+          std::vector<std::vector<double>> m_history;
+          std::vector<size_t> m_index;
+          std::vector<size_t> m_fill;
+          std::vector<double> m_sum;
+      };
+
+      /**
+         @brief First order IIR low-pass filter.
+      */
+      class LowPass : public Stage {
+        public:
+          /**
+             @param cutoff cut-off frequency in Hz
+          */
+          explicit LowPass (double cutoff);
+          virtual void prepare (int channels, double rate) override;
+          virtual size_t process (int channel, double *data, size_t count) override;
+          virtual void reset() override;
+
+        private:
+          double m_cutoff;
+          double m_alpha;
+          std::vector<double> m_state;
+          std::vector<bool> m_primed;
+      };
+
+      /**
+         @brief Keeps one sample out of n.
+      */
+      class Decimator : public Stage {
+        public:
+          explicit Decimator (size_t n);
+          virtual void prepare (int channels, double rate) override;
+          virtual size_t process (int channel, double *data, size_t count) override;
+          virtual double outputRate (double rate) const override;
+          virtual void reset() override;
+
+        private:
+          size_t m_n;
+          std::vector<size_t> m_phase;
+      };
+
+      /**
+         @brief Reduces each window of n samples to a single value.
+      */
+      class Window : public Stage {
+        public:
+          enum Function {
+            Min,
+            Max,
+            Mean,
+            Rms
+          };
+
+          Window (Function function, size_t n);
+          virtual void prepare (int channels, double rate) override;
+          virtual size_t process (int channel, double *data, size_t count) override;
+          virtual double outputRate (double rate) const override;
+          virtual void reset() override;
+
+        private:
+          Function m_function;
+          size_t m_n;
+          std::vector<size_t> m_fill;
+          std::vector<double> m_acc;
+      };
+
+      /**
+         @brief Output of the pipeline.
+      */
+      class Sink {
+        public:
+          virtual ~Sink() {}
+
+          /**
+             @brief Called by Pipeline::start().
+             @param first first channel of the source
+             @param channels number of channels
+             @param rate frame rate at the input of the sink in Hz
+             @param blockSize maximum number of frames of a write() call
+             @return false if the sink can not be used, the pipeline does not start.
+          */
+          virtual bool prepare (int /*first*/, int /*channels*/, double /*rate*/, size_t /*blockSize*/) {
+            return true;
+          }
+
+          /**
+             @brief Writes a block.
+             @param data array of channels pointers, data[c][i] is the sample i of the channel c
+             @param count number of samples of each channel
+             @return false on error
+          */
+          virtual bool write (const double *const *data, size_t count) = 0;
+
+          /**
+             @brief Called by Pipeline::stop().
+          */
+          virtual void flush() {}
+      };
+
+      /**
+         @brief Stores the frames in a lock-free ring, for another thread.
+      */
+      class RingSink : public Sink {
+        public:
+          explicit RingSink (size_t frames = 4096);
+          virtual bool prepare (int first, int channels, double rate, size_t blockSize) override;
+          virtual bool write (const double *const *data, size_t count) override;
+
+          /**
+             @brief Reads up to count frames, channel values are interleaved.
+             @return the number of frames copied to frames
+          */
+          size_t read (double *frames, size_t count);
+
+          /**
+             @brief Number of frames ready to be read.
+          */
+          size_t available() const;
+
+          /**
+             @brief Number of frames dropped because the ring was full.
+          */
+          unsigned long overruns() const {
+            return m_overruns;
+          }
+
+        private:
+          size_t m_frames;
+          int m_channels;
+          std::unique_ptr<SpscRing<double>> m_ring;
+          std::atomic<unsigned long> m_overruns;
+      };
+
+      /**
+         @brief Writes the frames to a file, as CSV text or as raw doubles.
+      */
+      class FileSink : public Sink {
+        public:
+          FileSink (const std::string &path, bool binary = false);
+          virtual bool prepare (int first, int channels, double rate, size_t blockSize) override;
+          virtual bool write (const double *const *data, size_t count) override;
+          virtual void flush() override;
+
+        private:
+          std::string m_path;
+          bool m_binary;
+          int m_channels;
+          std::ofstream m_file;
+      };
+
+      /**
+         @brief Writes the frames to another converter (DAC).
+
+         The channel c of the pipeline is written to the channel first + c of
+         the converter, all the channels of a frame with Converter::writeChannels().
+      */
+      class ConverterSink : public Sink {
+        public:
+          /**
+             @param dac converter, opened by the sink if it is closed
+             @param first first channel of the converter
+             @param owner if true, the converter is deleted by the sink
+          */
+          ConverterSink (Converter *dac, int first = 0, bool owner = false);
+          virtual ~ConverterSink();
+          virtual bool prepare (int first, int channels, double rate, size_t blockSize) override;
+          virtual bool write (const double *const *data, size_t count) override;
+
+        private:
+          Converter *m_dac;
+          int m_first;
+          bool m_owner;
+          int m_channels;
+          unsigned long m_mask;
+          size_t m_blockSize;
+          std::vector<std::vector<long>> m_digital;
+          std::vector<long> m_frame;
+      };
+
+      /**
+         @brief Constructor with an existing converter.
+         @param source converter, it is not owned by the pipeline
+         @param first first channel of the acquisition
+         @param last last channel of the acquisition
+      */
+      Pipeline (Converter *source, int first = 0, int last = 0);
+
+      /**
+         @brief Constructor with a converter spec string, see Converter::factory().
+         @param sourceSpec converter spec string, the converter is owned by the pipeline
+         @param first first channel of the acquisition
+         @param last last channel of the acquisition
+      */
+      Pipeline (const std::string &sourceSpec, int first = 0, int last = 0);
+
+      /**
+         @brief Destructor, stops the pipeline.
+      */
+      virtual ~Pipeline();
+
+      /**
+         @brief Returns the source converter.
+      */
+      Converter *source() const;
+
+      /**
+         @brief Appends a stage, the pipeline takes its ownership.
+         @return false if the pipeline is running.
+      */
+      bool addStage (Stage *stage);
+
+      /**
+         @brief Appends a stage created from a spec string.
+         @return false if the spec is invalid or if the pipeline is running.
+      */
+      bool addStage (const std::string &spec);
+
+      /**
+         @brief Appends a sink, the pipeline takes its ownership.
+         @return false if the pipeline is running.
+      */
+      bool addSink (Sink *sink);
+
+      /**
+         @brief Appends a sink created from a spec string.
+         @return false if the spec is invalid or if the pipeline is running.
+      */
+      bool addSink (const std::string &spec);
+
+      /**
+         @brief Creates a stage from a spec string.
+         @return the stage, nullptr if the spec is invalid.
+      */
+      static Stage *stageFactory (const std::string &spec);
+
+      /**
+         @brief Creates a sink from a spec string.
+         @return the sink, nullptr if the spec is invalid.
+      */
+      static Sink *sinkFactory (const std::string &spec);
+
+      /**
+         @brief Starts the acquisition and the processing thread.
+         @param rate scan rate of the source in Hz
+         @param blockSize number of frames processed at once
+         @return false if the source could not be opened or started, or if a sink could not be prepared.
+      */
+      bool start (double rate, size_t blockSize = 64);
+
+      /**
+         @brief Stops the processing thread and the acquisition, then flushes the sinks.
+      */
+      void stop();
+
+      /**
+         @brief Returns true if the pipeline is running.
+      */
+      bool isRunning() const;
+
+      /**
+         @brief Frame rate at the output of the last stage in Hz.
+      */
+      double outputRate() const;
+
+      /**
+         @brief Number of frames written to the sinks since the start.
+      */
+      unsigned long framesOut() const;
+
+      /**
+         @brief Number of incomplete scans dropped since the start.
+      */
+      unsigned long droppedScans() const;
+
+    protected:
+      class Private;
+      Pipeline (Private &dd);
+      std::shared_ptr<Private> d_ptr;
+
+    private:
+      PIMP_DECLARE_PRIVATE (Pipeline)
+  };
+}
+/* ========================================================================== */
@@ -0,0 +1,338 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdint>
+#include <bitset>
+#include <functional>
+#include <algorithm>
+
+namespace Piduino {
+
+  /**
+     @enum RegisterPolicy
+     @brief Caching policy of a peripheral register.
+
+     - RegisterVolatile:  the value may change on the hardware side (input port, status...),
+                          every read goes to the bus.
+     - RegisterCached:    the value only changes when written by the host, reads are
+                          served from the cache once it has been loaded.
+     - RegisterWriteOnly: the register can not be read back, the cache is the only copy.
+  */
+  enum RegisterPolicy {
+    RegisterVolatile,
+    RegisterCached,
+    RegisterWriteOnly
+  };
+
+  /**
+     @class RegisterMap
+     @brief Cached image of the 8-bit registers of a peripheral.
+
+     The map holds a shadow copy of the registers of a device, tracks which entries
+     are valid and which have been modified since the last transfer, and issues
+     burst transfers on the bus through the read and write functions provided
+     by the driver. It is bus-agnostic: I2C and SPI drivers only have to supply
+     functions that transfer \c len consecutive registers starting at \c reg.
+
+     The \c Layout class describes the device and must provide:
+     - \c Size: number of registers, addressed from 0 to Size - 1,
+     - \c BurstGroup: alignment of the register groups that the device auto-increments
+       through, a burst never crosses a group boundary (use Size if the whole map can
+       be transferred at once),
+     - <tt>static RegisterPolicy policy (uint8_t reg)</tt>: policy of each register.
+
+     Example:
+     @code
+     struct MyLayout {
+       enum { Size = 9, BurstGroup = 2 };
+       static RegisterPolicy policy (uint8_t reg) {
+         return reg < 2 ? RegisterVolatile : RegisterCached;
+       }
+     };
+     @endcode
+  */
+  template <class Layout>
+  class RegisterMap {
+
+    public:
+      enum {
+        Size = Layout::Size,
+        BurstGroup = Layout::BurstGroup
+      };
+
+      /**
+         @brief Bus read function, reads \c len registers starting at \c reg into \c buf.
+         @return the number of bytes read, or -1 on error.
+      */
+      typedef std::function<int (uint8_t reg, uint8_t *buf, uint16_t len)> ReadFunction;
+
+      /**
+         @brief Bus write function, writes \c len registers starting at \c reg from \c buf.
+         @return the number of bytes written, or -1 on error.
+      */
+      typedef std::function<int (uint8_t reg, const uint8_t *buf, uint16_t len)> WriteFunction;
+
+      /**
+         @brief Constructor
+         @param rd function used to read registers from the device
+         @param wr function used to write registers to the device
+      */
+      RegisterMap (ReadFunction rd, WriteFunction wr) :
+        _read (rd), _write (wr), _data{0} {}
+
+      /**
+         @brief Returns the policy of a register
+      */
+      static RegisterPolicy policy (uint8_t reg) {
+        return Layout::policy (reg);
+      }
+
+      /**
+         @brief Returns the cached value of a register, without any bus access
+      */
+      uint8_t value (uint8_t reg) const {
+        return _data[reg];
+      }
+
+      /**
+         @brief Returns a pointer on the cached registers
+      */
+      const uint8_t *data() const {
+        return _data;
+      }
+
+      /**
+         @brief Gets the value of a register
+
+         Volatile registers and registers not yet loaded are read from the device,
+         others are served from the cache.
+         @param reg register address
+         @param v receives the value
+         @return true on success, false on bus error
+      */
+      bool get (uint8_t reg, uint8_t &v) {
+
+        if (reg >= Size) {
+          return false;
+        }
+        if (!isFresh (reg)) {
+          if (!refresh (reg, 1)) {
+            return false;
+          }
+        }
+        v = _data[reg];
+        return true;
+      }
+
+      /**
+         @brief Loads a register if its cached value can not be used
+         @return true if the cached value is usable after the call
+      */
+      bool fetch (uint8_t first, uint8_t count = 1) {
+        bool success = true;
+
+        for (uint8_t reg = first; reg < first + count && reg < Size; reg++) {
+          if (!isFresh (reg)) {
+            // load the rest of the group at once
+            uint8_t last = std::min<int> (first + count, Size);
+            success = refresh (reg, last - reg) && success;
+            break;
+          }
+        }
+        return success;
+      }
+
+      /**
+         @brief Modifies the cached value of a register
+
+         The register is marked dirty if its value changes (or if it has never
+         been loaded), nothing is sent before flush().
+      */
+      void set (uint8_t reg, uint8_t v) {
+
+        if (reg < Size) {
+          if (!_valid[reg] || _data[reg] != v || policy (reg) == RegisterVolatile) {
+            _data[reg] = v;
+            _valid[reg] = true;
+            _dirty[reg] = true;
+          }
+        }
+      }
+
+      /**
+         @brief Modifies the bits of the cached value of a register
+         @param reg register address
+         @param mask bits to modify
+         @param bits new value of the bits selected by mask
+      */
+      void setBits (uint8_t reg, uint8_t mask, uint8_t bits) {
+
+        if (reg < Size) {
+          set (reg, (_data[reg] & ~mask) | (bits & mask));
+        }
+      }
+
+      /**
+         @brief Updates the cache without marking the register dirty
+
+         Used when the driver knows the hardware value (reset default...).
+      */
+      void load (uint8_t reg, uint8_t v) {
+
+        if (reg < Size) {
+          _data[reg] = v;
+          _valid[reg] = true;
+          _dirty[reg] = false;
+        }
+      }
+
+      /**
+         @brief Writes all the dirty registers to the device
+
+         Adjacent dirty registers of the same group are sent in a single burst.
+         Registers successfully written are marked clean, the others stay dirty
+         and will be sent again on the next call.
+         @return true on success, false if at least one burst failed
+      */
+      bool flush() {
+        bool success = true;
+        uint8_t reg = 0;
+
+        while (reg < Size) {
+
+          if (_dirty[reg]) {
+            uint8_t len = 1;
+
+            while ( (reg + len) < Size && _dirty[reg + len] &&
+                    ( (reg + len) % BurstGroup) != 0) {
+              len++;
+            }
+
+            if (_write (reg, &_data[reg], len) == len) {
+              for (uint8_t i = reg; i < reg + len; i++) {
+                _dirty[i] = false;
+              }
+            }
+            else {
+              success = false;
+            }
+            reg += len;
+          }
+          else {
+            reg++;
+          }
+        }
+        return success;
+      }
+
+      /**
+         @brief Reads a range of registers from the device
+
+         Write-only registers are skipped, dirty registers are read but their
+         cached value is kept so that pending modifications are not lost.
+         The range is split on group boundaries.
+         @param first first register address
+         @param count number of registers
+         @return true on success, false if at least one burst failed
+      */
+      bool refresh (uint8_t first = 0, uint8_t count = Size) {
+        bool success = true;
+        uint8_t end = std::min<int> (first + count, Size);
+        uint8_t reg = first;
+
+        while (reg < end) {
+
+          if (policy (reg) != RegisterWriteOnly) {
+            uint8_t buf[Size];
+            uint8_t len = 1;
+
+            while ( (reg + len) < end && policy (reg + len) != RegisterWriteOnly &&
+                    ( (reg + len) % BurstGroup) != 0) {
+              len++;
+            }
+
+            if (_read (reg, buf, len) == len) {
+              for (uint8_t i = 0; i < len; i++) {
+                if (!_dirty[reg + i]) {
+                  _data[reg + i] = buf[i];
+                }
+                _valid[reg + i] = true;
+              }
+            }
+            else {
+              success = false;
+            }
+            reg += len;
+          }
+          else {
+            reg++;
+          }
+        }
+        return success;
+      }
+
+      /**
+         @brief Marks a range of registers invalid, they will be read on next access
+      */
+      void invalidate (uint8_t first = 0, uint8_t count = Size) {
+
+        for (uint8_t reg = first; reg < first + count && reg < Size; reg++) {
+          if (policy (reg) != RegisterWriteOnly) {
+            _valid[reg] = false;
+            _dirty[reg] = false;
+          }
+        }
+      }
+
+      /**
+         @brief Returns true if at least one register is waiting to be written
+      */
+      bool isDirty() const {
+        return _dirty.any();
+      }
+
+      /**
+         @brief Returns true if the register is waiting to be written
+      */
+      bool isDirty (uint8_t reg) const {
+        return reg < Size && _dirty[reg];
+      }
+
+      /**
+         @brief Returns true if the cached value of the register has been loaded or set
+      */
+      bool isValid (uint8_t reg) const {
+        return reg < Size && _valid[reg];
+      }
+
+    private:
+      // true if the cached value can be returned without bus access
+      bool isFresh (uint8_t reg) const {
+        RegisterPolicy p = policy (reg);
+
+        return (p == RegisterWriteOnly) || (p == RegisterCached && _valid[reg]);
+      }
+
+      ReadFunction _read;
+      WriteFunction _write;
+      uint8_t _data[Size];
+      std::bitset<Size> _valid;
+      std::bitset<Size> _dirty;
+  };
+}
+/* ========================================================================== */
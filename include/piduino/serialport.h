@@ -28,6 +28,8 @@
  */
 namespace Piduino {
 
+  class Pin;
+
   /**
    * @class SerialPort
    * @brief Provides functions to access serial ports.
@@ -375,6 +377,20 @@ namespace Piduino {
           static std::string flowControlToString (FlowControl flowControl);
       };
 
+      /**
+       * @class Latency
+       * @brief Latency statistics returned by measureLatency(), in microseconds
+       */
+      class Latency {
+        public:
+          Latency() : samples (0), min (0), mean (0), max (0) {}
+
+          unsigned long samples; ///< number of bytes received
+          double min; ///< lowest latency
+          double mean; ///< mean latency
+          double max; ///< highest latency
+      };
+
       /**
        * @class Info
        * @brief Provides information about existing serial ports.
@@ -533,6 +549,10 @@ namespace Piduino {
 
           /**
             Returns a list of available serial ports on the system.
+
+            The ports are enumerated through udev on the first call only, the
+            list is then kept current by a udev monitor (ports plugged or
+            unplugged), the ports plugged are checked on the next call.
            */
           static std::deque<Info> availablePorts ();
 
@@ -805,6 +825,95 @@ namespace Piduino {
       bool setBreakEnabled (bool set = true);
       bool isBreakEnabled() const;
 
+      /**
+        @property SerialPort::lowLatency
+        @brief the low latency profile of the port
+
+        When enabled, the driver is asked to push each received byte to the
+        line discipline without delay (ASYNC_LOW_LATENCY, if the driver
+        supports it), the read threshold is set to 1 byte and the port is read
+        by a thread of its own, with the real-time priority @a rtPriority
+        (0 for the normal scheduling), see TerminalNotifier::setDedicatedThread().
+
+        Returns @c true on success, @c false if the driver refused the flag.
+
+        @note If the port is open, the driver flag and the read threshold are
+        applied immediately, the reading thread at the next opening.
+
+        The default value is @c false.
+       */
+      bool setLowLatency (bool enable, int rtPriority = 0);
+      bool isLowLatency() const;
+
+      /**
+        @property SerialPort::readThreshold
+        @brief the number of received bytes that wakes up the reader (VMIN)
+
+        With a threshold greater than 1, the reader is woken up once per
+        @a bytes bytes instead of once per byte, which suits the protocols
+        with fixed size packets. The bytes of a shorter packet stay in the
+        driver until the next one is received, so the threshold must not
+        exceed the size of the shortest packet. Returns @c false if
+        @a bytes is not between 1 and 255 or if the setting failed.
+
+        The default value is 1.
+       */
+      bool setReadThreshold (int bytes);
+      int readThreshold() const;
+
+      /**
+        Measures the delay between the end of a byte on the line and its
+        reception by the application, the TX and RX lines must be connected
+        together (loopback). The bytes are sent one at a time, the
+        transmission time of a byte is subtracted from each sample.
+
+        @param samples number of bytes sent
+        @param msTimeout maximum waiting time of each byte in milliseconds
+        @return the statistics, samples is 0 if the port is not open in
+        read-write mode or if no byte was received.
+
+        @note The bytes waiting to be read are discarded.
+       */
+      Latency measureLatency (int samples = 100, long msTimeout = 100);
+
+      /**
+        @property SerialPort::frameGap
+        @brief the silence that separates two received frames, in characters
+
+        Sets the gap of the TerminalNotifier from the time of a character at
+        the current baud rate, the gap is updated when the baud rate changes.
+        Above 19200 baud, the gap is at least 1750 µs for 3.5 characters, as
+        for Modbus RTU. The frames are then read with
+        TerminalNotifier::readFrame() or a frame handler.
+
+        @param characters silence in characters, 0 disables the framing
+       */
+      void setFrameGap (double characters = 3.5);
+      double frameGap() const;
+
+      /**
+        @property SerialPort::rs485Pin
+        @brief the pin that drives the DE/RE inputs of the RS485 transceiver
+
+        In the RS485 modes (Rs485AfterSendControl, Rs485OnSendControl), the
+        direction is driven by the driver when it supports TIOCSRS485 (see
+        hasKernelRs485()), write() then returns as soon as the bytes are
+        queued. Otherwise, or if a pin is set, write() enables the transmitter,
+        writes, waits for the transmitter of the UART to be empty
+        (TIOCSERGETLSR) and releases the bus right after the last stop bit.
+
+        @param pin output pin, nullptr to use RTS, the pin is written through its
+        registers if the GPIO device allows it
+        @param activeHigh true if the high level enables the transmitter
+       */
+      void setRs485Pin (Pin * pin, bool activeHigh = true);
+      Pin * rs485Pin() const;
+
+      /**
+        Returns @c true if the RS485 direction is driven by the driver.
+       */
+      bool hasKernelRs485() const;
+
 
       /**
         @overload
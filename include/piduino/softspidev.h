@@ -0,0 +1,121 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <piduino/spidev.h>
+
+/**
+ *  @addtogroup piduino_spidev
+ *  @{
+ */
+
+namespace Piduino {
+
+  /**
+   * @class SoftSpiDev
+   * @brief Bus SPI maître logiciel
+   *
+   * Les signaux SCK, MOSI et CS sont générés en écrivant directement dans les
+   * registres de mise à 1 et de mise à 0 des ports GPIO (GPSET/GPCLR sur
+   * BCM2835, SET/CLR du RIO sur RP1), MISO est lu dans le registre de niveau,
+   * les masques de chaque broche étant calculés à l'ouverture (cf
+   * \c Pin::port()). Sans limitation de vitesse (\c speedHz nul ou très
+   * élevé), l'horloge atteint plusieurs MHz sur Pi 4 et Pi 5.
+   *
+   * Un bus logiciel enregistré par \c registerBus() est vu comme un bus SPI de
+   * la carte : \c SpiDev::Info, \c SpiDev et \c SPIClass l'utilisent avec son
+   * numéro de bus, sans modification des drivers existants. Les modes
+   * (CPOL, CPHA, SPI_CS_HIGH, SPI_NO_CS, SPI_LSB_FIRST), les vitesses et les
+   * nombres de bits par mot (jusqu'à 32) des transferts sont gérés comme par
+   * le driver spidev.
+   *
+   * @code
+   * SoftSpiDev::registerBus (5, SoftSpiDev::Pins (11, 10, 9, {8, 7}));
+   * SPI.begin (5, 1); // CS sur la broche 7
+   * @endcode
+   */
+  class SoftSpiDev : public SpiDev {
+    public:
+
+      /**
+       * @class Pins
+       * @brief Broches d'un bus logiciel, numéros logiques (cf \c Gpio::pin())
+       */
+      class Pins {
+        public:
+          Pins (int sck = -1, int mosi = -1, int miso = -1, const std::vector<int> & cs = std::vector<int>()) :
+            sck (sck), mosi (mosi), miso (miso), cs (cs) {}
+
+          int sck; ///< horloge, obligatoire
+          int mosi; ///< données émises, -1 si inutilisée
+          int miso; ///< données reçues, -1 si inutilisée
+          std::vector<int> cs; ///< broches de CS, l'indice est le numéro de CS
+      };
+
+      /**
+       * @brief Enregistre un bus logiciel
+       * @param bus numéro du bus, inférieur à \c Info::MaxBuses et différent
+       * de ceux des bus matériels
+       * @param pins broches du bus
+       * @return false si le numéro est déjà utilisé ou si les broches sont invalides
+       */
+      static bool registerBus (int bus, const Pins & pins);
+
+      /**
+       * @brief Supprime un bus logiciel, les SpiDev ouverts sur ce bus
+       * continuent à l'utiliser jusqu'à leur fermeture
+       */
+      static void unregisterBus (int bus);
+
+      /**
+       * @brief Indique si \c bus est un bus logiciel enregistré
+       */
+      static bool isRegistered (int bus);
+
+      /**
+       * @brief Numéros des bus logiciels enregistrés
+       */
+      static std::vector<int> registeredBuses();
+
+      /**
+       * @brief Broches d'un bus logiciel enregistré, \c sck vaut -1 si le bus n'existe pas
+       */
+      static Pins busPins (int bus);
+
+      /**
+       * @brief Constructeur sur un bus logiciel déjà enregistré
+       */
+      explicit SoftSpiDev (int bus, int cs = 0);
+
+      /**
+       * @brief Constructeur enregistrant le bus si nécessaire
+       * Déclenche une exception std::system_error si le bus ne peut être enregistré
+       */
+      SoftSpiDev (int bus, const Pins & pins, int cs = 0);
+
+      /**
+       * @brief Destructeur
+       */
+      virtual ~SoftSpiDev();
+  };
+}
+/**
+ *  @}
+ */
+
+/* ========================================================================== */
@@ -19,6 +19,7 @@
 #include <deque>
 #include <map>
 #include <string>
+#include <vector>
 #include <piduino/iodevice.h>
 #include <piduino/gpiopin.h>
 #include <piduino/system.h>
@@ -73,6 +74,10 @@ namespace Piduino {
       /**
        * @class Cs
        * @brief Broche de chip select d'un bus SPI
+       *
+       * Lorsque le CS est géré par l'espace utilisateur (\c setDriverControl(false))
+       * et que la broche est accessible par la mémoire, \c set() et \c get()
+       * accèdent directement aux registres du port (cf \c Pin::port()).
        */
       class Cs {
         public:
@@ -105,6 +110,14 @@ namespace Piduino {
           bool get() const;
           void set (bool value);
 
+          /**
+           * @brief Accès direct aux registres de la broche, invalide si le CS
+           * est géré par le driver ou si la broche n'est pas accessible par la mémoire
+           */
+          inline const Pin::Port & port() const {
+            return _port;
+          }
+
         protected:
           inline void setId (int value) {
             _id = value;
@@ -122,6 +135,65 @@ namespace Piduino {
           Pin::Mode _mode;
           bool _driverControl;
           bool _activeLevel;
+          Pin::Port _port;
+      };
+
+      /**
+       * @class CsGroup
+       * @brief Ensemble de broches de CS gérées par l'espace utilisateur
+       *
+       * Permet à plusieurs circuits sur le même bus de disposer chacun de leur
+       * CS. Les masques de chaque port sont calculés par \c add(), \c select()
+       * désélectionne tous les autres circuits et sélectionne le circuit
+       * demandé avec un seul accès par registre de port : une seule écriture
+       * pour un port à registre de données, une écriture dans le registre de
+       * mise à 1 puis une dans celui de mise à 0 pour les autres.
+       */
+      class CsGroup {
+        public:
+          /**
+           * @brief Ajoute une broche de CS
+           * @return indice de la broche dans le groupe, -1 si le CS est géré
+           * par le driver
+           */
+          int add (const Cs & cs);
+
+          /**
+           * @brief Sélectionne le circuit \c index et désélectionne tous les autres
+           * @param index indice retourné par \c add(), -1 pour tout désélectionner
+           */
+          void select (int index);
+
+          /**
+           * @brief Désélectionne tous les circuits
+           */
+          inline void deselectAll() {
+            select (-1);
+          }
+
+          inline size_t size() const {
+            return _members.size();
+          }
+
+          inline void clear() {
+            _members.clear();
+            _banks.clear();
+          }
+
+        private:
+          class Bank {
+            public:
+              Pin::Port port;
+              uint32_t idleHigh; ///< broches actives à l'état bas
+              uint32_t idleLow; ///< broches actives à l'état haut
+          };
+          class Member {
+            public:
+              Cs cs;
+              int bank; ///< -1 si la broche n'est pas accessible par la mémoire
+          };
+          std::vector<Bank> _banks;
+          std::vector<Member> _members;
       };
 
       /**
@@ -160,9 +232,16 @@ namespace Piduino {
             return _csList.at (_cs);
           }
           
-          inline bool exists() const {
-            return System::charFileExists(_path);
-          }
+          /**
+           * @brief Indique si le bus existe, fichier /dev ou bus logiciel
+           * enregistré par \c SoftSpiDev::registerBus()
+           */
+          bool exists() const;
+
+          /**
+           * @brief Indique si le bus est un bus logiciel (\c SoftSpiDev)
+           */
+          bool isSoft() const;
 
           bool operator== (const Info & other) {
             return (_path == other._path) ;
@@ -173,7 +252,8 @@ namespace Piduino {
           }
 
           /**
-           * @brief Liste des bus disponibles sur le systèmes
+           * @brief Liste des bus disponibles sur le systèmes, y compris les
+           * bus logiciels enregistrés
            */
           static std::deque<SpiDev::Info> availableBuses ();
 
@@ -187,7 +267,7 @@ namespace Piduino {
            * @brief Chemin système correspondant à un bus
            * @param bus identifiant du bus
            * @param cs identifiant du chip select
-           * @return Chemin du fichier dans /dev
+           * @return Chemin du fichier dans /dev, \c softspiB.C pour un bus logiciel
            */
           static std::string busPath (int bus, int cs = 0);
 
@@ -268,6 +348,118 @@ namespace Piduino {
           }
       };
 
+      /**
+       * @class Message
+       * @brief Lot de transferts réutilisable
+       *
+       * Le tableau de spi_ioc_transfer est alloué une seule fois par le
+       * constructeur. Le message peut être construit une fois puis transmis
+       * à chaque itération par \c transfer(Message&) en ne modifiant que les
+       * pointeurs et longueurs des buffers, sans aucune allocation.
+       *
+       * Une vitesse ou un nombre de bits par mot nul lors de l'ajout d'un
+       * transfert est remplacé à chaque transmission par le réglage du SpiDev
+       * utilisé.
+       */
+      class Message {
+        public:
+          friend class SpiDev;
+
+          /**
+           * @brief Constructeur
+           * @param capacity nombre maximal de transferts du message
+           */
+          explicit Message (size_t capacity = 8);
+
+          /**
+           * @brief Ajout d'un transfert
+           * @return false si le message est plein
+           */
+          bool push (const uint8_t * txbuf, uint8_t * rxbuf, uint32_t len);
+
+          /**
+           * @brief Ajout d'un transfert à partir d'un objet Transfer
+           * @return false si le message est plein
+           */
+          bool push (const Transfer & t);
+
+          /**
+           * @brief Modification des buffers du transfert \c i
+           */
+          void setBuffers (size_t i, const uint8_t * txbuf, uint8_t * rxbuf, uint32_t len);
+
+          /**
+           * @brief Vitesse du transfert \c i, 0 pour celle du SpiDev
+           */
+          void setSpeedHz (size_t i, uint32_t speedHz);
+
+          /**
+           * @brief Nombre de bits par mot du transfert \c i, 0 pour celui du SpiDev
+           */
+          void setBitsPerWord (size_t i, uint8_t bitsPerWord);
+
+          /**
+           * @brief Accès au transfert \c i pour modifier les autres champs
+           * (cs_change, delay_usecs...), la vitesse et le nombre de bits par
+           * mot doivent être modifiés par setSpeedHz() et setBitsPerWord()
+           */
+          inline struct spi_ioc_transfer & operator[] (size_t i) {
+            return _xfer[i];
+          }
+
+          /**
+           * @brief Vide le message, la mémoire est conservée
+           */
+          inline void clear() {
+            _size = 0;
+          }
+
+          inline size_t size() const {
+            return _size;
+          }
+
+          inline size_t capacity() const {
+            return _xfer.size();
+          }
+
+          inline const struct spi_ioc_transfer * data() const {
+            return _xfer.data();
+          }
+
+        private:
+          enum {
+            AutoSpeed = 0x01,
+            AutoBits = 0x02
+          };
+          void applyDefaults (uint32_t speedHz, uint8_t bitsPerWord);
+
+          std::vector<struct spi_ioc_transfer> _xfer;
+          std::vector<uint8_t> _auto; ///< champs pris dans les réglages du SpiDev
+          size_t _size;
+      };
+
+      /**
+       * @class Transaction
+       * @brief Verrou RAII d'une transaction sur le bus
+       *
+       * Le constructeur appelle \c beginTransaction(), le destructeur
+       * \c endTransaction().
+       */
+      class Transaction {
+        public:
+          explicit Transaction (SpiDev & dev) : _dev (dev) {
+            _dev.beginTransaction();
+          }
+          ~Transaction() {
+            _dev.endTransaction();
+          }
+          Transaction (const Transaction &) = delete;
+          Transaction & operator= (const Transaction &) = delete;
+
+        private:
+          SpiDev & _dev;
+      };
+
       /**
        * @brief Constructeur par défaut
        */
@@ -397,6 +589,87 @@ namespace Piduino {
        */
       int transfer ();
 
+      /**
+       * @brief Transmission d'un message préparé
+       * Les transferts du message sont transmis par un seul appel système
+       * SPI_IOC_MESSAGE, sans allocation. La pile de transmission n'est pas
+       * utilisée.
+       * @return nombre d'octets transmis, valeur négative si erreur, dans ce
+       * cas error() et errorString() peuvent être utilisé pour connaître la raison.
+       */
+      int transfer (Message & msg);
+
+      /**
+       * @brief Début d'une transaction
+       * Donne l'accès exclusif au bus à ce thread, tous les SpiDev ouverts sur
+       * le même fichier /dev du processus partageant le même verrou. Les
+       * transferts effectués en dehors d'une transaction prennent le verrou
+       * le temps de l'appel. Les transactions peuvent être imbriquées.
+       */
+      void beginTransaction();
+
+      /**
+       * @brief Fin d'une transaction
+       */
+      void endTransaction();
+
+      /**
+       * @brief Taille maximale d'un appel système de transfert
+       * Limite \c bufsiz du driver spidev (/sys/module/spidev/parameters/bufsiz),
+       * 4096 par défaut. Les transferts de \c transfer(txbuf, rxbuf, len)
+       * plus longs sont découpés automatiquement, le CS restant activé entre
+       * les morceaux si le driver du contrôleur le permet.
+       */
+      uint32_t maxTransferSize() const;
+
+      /**
+       * @brief Démarrage de la lecture en continu
+       * Un thread lit en boucle le bus dans un anneau de \c nofBuffers buffers
+       * de \c bufferSize octets, les appels SPI_IOC_MESSAGE s'enchaînant sans
+       * attendre le consommateur tant qu'un buffer est libre. Chaque buffer est
+       * transmis avec le CS activé du début à la fin (découpé à
+       * maxTransferSize()).
+       * @param bufferSize taille de chaque buffer en octets
+       * @param nofBuffers nombre de buffers de l'anneau (au moins 2)
+       * @param txbuf octets transmis sur MOSI pour chaque buffer (copiés,
+       * \c bufferSize octets), 0 pour transmettre des 0.
+       * @return false si le bus n'est pas ouvert ou si le thread n'a pu être créé
+       */
+      bool startStream (uint32_t bufferSize, int nofBuffers = 4, const uint8_t * txbuf = 0);
+
+      /**
+       * @brief Arrêt de la lecture en continu
+       */
+      void stopStream();
+
+      /**
+       * @brief Indique si la lecture en continu est en cours
+       */
+      bool isStreaming() const;
+
+      /**
+       * @brief Buffer suivant de la lecture en continu, sans copie
+       * Le buffer retourné appartient à l'appelant jusqu'au prochain appel à
+       * \c streamBuffer() ou à \c releaseStreamBuffer(), il n'est pas réécrit
+       * par le thread pendant ce temps.
+       * @param timeoutMs délai d'attente maximal en millisecondes, -1 pour
+       * attendre indéfiniment
+       * @return pointeur sur \c bufferSize octets, 0 si le délai est écoulé ou
+       * si la lecture est arrêtée (erreur de transfert par exemple)
+       */
+      const uint8_t * streamBuffer (int timeoutMs = -1);
+
+      /**
+       * @brief Rend au thread le buffer obtenu par \c streamBuffer()
+       */
+      void releaseStreamBuffer();
+
+      /**
+       * @brief Nombre de fois où le thread a dû attendre un buffer libre
+       * Chaque attente correspond à une interruption de la lecture continue.
+       */
+      unsigned long streamOverruns() const;
+
       /**
        * @brief Vidage de la pile de transmission
        * Pas nécessaire après transfer()
@@ -405,8 +678,11 @@ namespace Piduino {
 
       /**
        * @brief Modification des réglages de la transmission
-       * Si la liaison est ouverte les réglages sont appliqués immédiatement,
-       * sinon ils le seront à l'ouverture par \c open()
+       * La vitesse et le nombre de bits par mot sont transmis avec chaque
+       * transfert. Le mode et l'ordre des bits sont appliqués au driver lors
+       * du transfert suivant, uniquement s'ils diffèrent de ceux du dernier
+       * SpiDev ayant utilisé le bus : alterner entre deux circuits sur le
+       * même bus ne coûte aucun appel système supplémentaire.
        */
       void setSettings (const Settings & settings);
 
@@ -422,29 +698,25 @@ namespace Piduino {
        * - SPI_3WIRE mode 3 fils (MISO/MOSI sur le même fil)
        * - SPI_NO_CS chip select géré de l'espace utilisateur
        * - .
-       * Si la liaison est ouverte les réglages sont appliqués immédiatement,
-       * sinon ils le seront à l'ouverture par \c open()
+       * Appliqué au driver lors du transfert suivant s'il a changé, cf \c setSettings()
        */
       void setMode (uint8_t mode);
 
       /**
        * @brief Modification de la vitesse maximale de transmission en Hz
-       * Si la liaison est ouverte les réglages sont appliqués immédiatement,
-       * sinon ils le seront à l'ouverture par \c open()
+       * Transmise avec chaque transfert, sans appel système
        */
       void setSpeedHz (uint32_t speedHz);
 
       /**
        * @brief Modification du nombre de bits par mot
-       * Si la liaison est ouverte les réglages sont appliqués immédiatement,
-       * sinon ils le seront à l'ouverture par \c open()
+       * Transmis avec chaque transfert, sans appel système
        */
       void setBitsPerWord (uint8_t bit);
 
       /**
        * @brief Modification de l'ordre de transmission des bits \c MsbFirst ou \c LsbFirst
-       * Si la liaison est ouverte les réglages sont appliqués immédiatement,
-       * sinon ils le seront à l'ouverture par \c open()
+       * Appliqué au driver lors du transfert suivant s'il a changé, cf \c setSettings()
        */
       void setBitOrder (bool bitOrder);
 
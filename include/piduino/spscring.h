@@ -0,0 +1,153 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace Piduino {
+
+  /**
+     @class SpscRing
+     @brief Lock-free ring buffer for one producer thread and one consumer thread.
+
+     The producer only modifies the head index and the consumer only modifies
+     the tail index, so no lock is needed as long as push() is called from a
+     single thread and pop() from a single (possibly different) thread.
+     The capacity is rounded up to a power of two, the storage is allocated
+     once by the constructor. When the ring is full, push() refuses the new
+     elements, it never blocks and never overwrites unread data.
+
+     @tparam T Type of the elements, must be copy-assignable.
+  */
+  template <typename T>
+  class SpscRing {
+
+    public:
+      /**
+         @brief Constructor
+         @param capacity minimum number of elements the ring can hold
+      */
+      explicit SpscRing (size_t capacity = 1024) :
+        m_mask (roundUp (capacity) - 1), m_buffer (m_mask + 1), m_head (0), m_tail (0) {}
+
+      /**
+         @brief Number of elements the ring can hold.
+      */
+      size_t capacity() const {
+        return m_mask + 1;
+      }
+
+      /**
+         @brief Number of elements ready to be read.
+      */
+      size_t size() const {
+        return m_head.load (std::memory_order_acquire) - m_tail.load (std::memory_order_acquire);
+      }
+
+      /**
+         @brief Returns true if there is no element to read.
+      */
+      bool empty() const {
+        return size() == 0;
+      }
+
+      /**
+         @brief Number of elements that can be pushed.
+      */
+      size_t space() const {
+        return capacity() - size();
+      }
+
+      /**
+         @brief Pushes an element, producer side.
+         @return false if the ring is full, the element is dropped.
+      */
+      bool push (const T &item) {
+        return push (&item, 1) == 1;
+      }
+
+      /**
+         @brief Pushes an array of elements, producer side.
+         @return the number of elements pushed, less than \c count if the ring is full.
+      */
+      size_t push (const T *items, size_t count) {
+        size_t head = m_head.load (std::memory_order_relaxed);
+        size_t tail = m_tail.load (std::memory_order_acquire);
+
+        count = std::min (count, capacity() - (head - tail));
+        for (size_t i = 0; i < count; i++) {
+
+          m_buffer[ (head + i) & m_mask] = items[i];
+        }
+        m_head.store (head + count, std::memory_order_release);
+        return count;
+      }
+
+      /**
+         @brief Pops an element, consumer side.
+         @return false if the ring is empty.
+      */
+      bool pop (T &item) {
+        return pop (&item, 1) == 1;
+      }
+
+      /**
+         @brief Pops up to \c count elements, consumer side.
+         @return the number of elements copied to \c items.
+      */
+      size_t pop (T *items, size_t count) {
+        size_t tail = m_tail.load (std::memory_order_relaxed);
+        size_t head = m_head.load (std::memory_order_acquire);
+
+        count = std::min (count, head - tail);
+        for (size_t i = 0; i < count; i++) {
+
+          items[i] = m_buffer[ (tail + i) & m_mask];
+        }
+        m_tail.store (tail + count, std::memory_order_release);
+        return count;
+      }
+
+      /**
+         @brief Drops all the elements, consumer side.
+      */
+      void clear() {
+        m_tail.store (m_head.load (std::memory_order_acquire), std::memory_order_release);
+      }
+
+    private:
+      static size_t roundUp (size_t n) {
+        size_t p = 1;
+
+        while (p < n) {
+          p <<= 1;
+        }
+        return p;
+      }
+
+      const size_t m_mask;
+      std::vector<T> m_buffer;
+      // head and tail are written by different threads, keep them on different cache lines
+      std::atomic<size_t> m_head;
+      char m_padding[64 - sizeof (std::atomic<size_t>)];
+      std::atomic<size_t> m_tail;
+  };
+}
+/* ========================================================================== */
@@ -17,8 +17,11 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+#include <functional>
 #include <piduino/global.h>
 #include <piduino/filedevice.h>
+#include <piduino/bytering.h>
 
 /**
  *  @defgroup piduino_terminalnotifier Read Notifier
@@ -29,18 +32,59 @@ namespace Piduino {
 
   /**
    * @class TerminalNotifier
-   * @brief
+   * @brief Reads a terminal in a thread and stores the received bytes in a ring buffer
+   *
+   * By default, all the notifiers are served by a single thread of the
+   * library, sleeping in epoll_wait() until a terminal receives data.
+   * A latency critical port can have a thread of its own, see setDedicatedThread().
+   *
+   * For the protocols that separate their frames with a silence on the line
+   * (e.g. Modbus RTU), the received bytes can be delivered as whole frames
+   * instead, see setFrameGap().
    */
   class TerminalNotifier {
     public:
-      TerminalNotifier (FileDevice * io);
+      static const size_t DefaultBufferSize = 16384;
+      static const size_t MaxQueuedFrames = 64;
+
+      /**
+       * @brief Bytes received between two silences longer than frameGap()
+       */
+      class Frame {
+        public:
+          Frame() : begin (0), end (0) {}
+
+          std::string data;
+          int64_t begin; ///< reception time of the first chunk, CLOCK_MONOTONIC in ns
+          int64_t end; ///< reception time of the last chunk, CLOCK_MONOTONIC in ns
+      };
+      typedef std::function<void (const Frame & frame)> FrameHandler;
+
+      /**
+       * @param io terminal to read
+       * @param bufferSize capacity of the receive buffer in bytes, the bytes
+       * received when it is full are dropped and counted by overruns()
+       */
+      TerminalNotifier (FileDevice * io, size_t bufferSize = DefaultBufferSize);
       virtual ~TerminalNotifier();
 
       bool start ();
       void terminate();
       bool isRunning() const;
 
+      /**
+       * @brief Reads the terminal with a thread of its own instead of the
+       * shared thread, taken into account by the next start()
+       * @param enable true for a dedicated thread
+       * @param rtPriority real-time priority of the dedicated thread, 0 for
+       * the normal scheduling
+       */
+      void setDedicatedThread (bool enable, int rtPriority = 0);
+      bool hasDedicatedThread() const;
+
       size_t available() const;
+      size_t bufferSize() const;
+      unsigned long overruns() const;
 
       size_t read (char * buf, size_t len, long msTimeout = 0);
       size_t read (std::string & str, long msTimeout = 0);
@@ -50,6 +94,60 @@ namespace Piduino {
       size_t peek (std::string & str, long msTimeout = 0);
       bool peek (char & c, long msTimeout = 0);
 
+      /**
+       * @brief Received bytes, processed in place without copy
+       * The views stay valid until consume(), there must be a single consumer.
+       */
+      ByteRing::Views views (long msTimeout = 0);
+
+      /**
+       * @brief Removes len bytes processed through views()
+       */
+      void consume (size_t len);
+
+      /**
+       * @brief Reception time of the last chunk of bytes read from the
+       * terminal, CLOCK_MONOTONIC in nanoseconds, 0 if nothing was received
+       */
+      int64_t lastReceived() const;
+
+      /**
+       * @brief Splits the received bytes into frames
+       *
+       * A frame ends when no byte is received during @a us microseconds,
+       * the silence is measured between the chunks read by the thread, so
+       * it can not be shorter than the latency of the driver (see
+       * SerialPort::setLowLatency()). While the framing is enabled, the
+       * received bytes are delivered by readFrame() or by the frame handler,
+       * no longer by read(), peek() and views().
+       * @param us minimum silence between two frames, 0 disables the framing
+       */
+      void setFrameGap (unsigned long us);
+      unsigned long frameGap() const;
+
+      /**
+       * @brief Calls @a handler with each frame, from the reading thread,
+       * instead of queuing it for readFrame(). An empty handler restores the
+       * queue. The handler must return quickly, the thread reads the other
+       * terminals too.
+       */
+      void setFrameHandler (FrameHandler handler);
+
+      /**
+       * @brief Removes the oldest frame of the queue
+       * @param msTimeout 0 returns immediately, -1 waits forever, otherwise
+       * waits at most msTimeout milliseconds for a frame
+       * @return false if no frame was received before the timeout
+       */
+      bool readFrame (Frame & frame, long msTimeout = 0);
+      size_t framesAvailable() const;
+
+      /**
+       * @brief Number of frames dropped because MaxQueuedFrames frames were
+       * waiting in the queue
+       */
+      unsigned long droppedFrames() const;
+
     protected:
       class Private;
       TerminalNotifier (Private &dd);
@@ -0,0 +1,179 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <piduino/global.h>
+#include <piduino/converter.h>
+
+namespace Piduino {
+
+  /**
+     @class WaveformPlayer
+     @brief Replays precomputed sample tables on a DAC at a fixed sample rate.
+
+     Each channel of the converter has its own table of digital values, the tables
+     are replayed in loop by a real-time thread. The write of each sample is
+     scheduled at an absolute deadline on the monotonic clock, so the rate does
+     not depend on the bus latency nor on the sleep jitter, as long as the bus
+     is fast enough.
+
+     For a single channel, setSamplesPerTransfer() sends several consecutive
+     samples with Converter::writeBlock(), the converters with a fast write mode
+     (e.g. MCP4725) send them in a single bus transaction, the spacing of the
+     samples inside a transfer is then given by the bus clock.
+     When several channels are played, each period is written with
+     Converter::writeChannels(), so that the channels are updated together.
+
+     @code
+     Converter *dac = Converter::factory ("mcp4725");
+     WaveformPlayer player (dac);
+
+     dac->open();
+     player.setWaveform (0, WaveformPlayer::Sine, 100, 1.5, 1.65); // 1.5V peak around 1.65V
+     player.setSampleRate (1000); // 10 Hz sine
+     player.start();
+     @endcode
+  */
+  class WaveformPlayer {
+    public:
+      /**
+         @brief Predefined waveforms of setWaveform()
+      */
+      enum Shape {
+        Sine,
+        Triangle,
+        Square,
+        Sawtooth
+      };
+
+      /**
+         @brief Constructor
+         @param dac converter of type DigitalToAnalog, it is not owned by the player
+      */
+      explicit WaveformPlayer (Converter *dac);
+
+      /**
+         @brief Destructor, stops the playback.
+      */
+      virtual ~WaveformPlayer();
+
+      /**
+         @brief Returns the converter.
+      */
+      Converter *converter() const;
+
+      /**
+         @brief Sets the table of a channel.
+         @param channel channel of the converter
+         @param samples digital values, replayed in loop
+         @return false if the player is running or the table is empty.
+      */
+      bool setTable (int channel, const std::vector<long> &samples);
+
+      /**
+         @brief Computes the table of a channel.
+         @param channel channel of the converter
+         @param shape waveform
+         @param length number of samples of a period
+         @param amplitude peak amplitude in the unit of the converter (volts)
+         @param offset center value in the unit of the converter (volts)
+         @return false if the player is running or length is null.
+      */
+      bool setWaveform (int channel, Shape shape, size_t length, double amplitude, double offset);
+
+      /**
+         @brief Removes all the tables.
+         @return false if the player is running.
+      */
+      bool clearTables();
+
+      /**
+         @brief Sets the sample rate in Hz.
+
+         The frequency of the waveform is the sample rate divided by the length
+         of the table.
+         @return false if the player is running or the rate is not positive.
+      */
+      bool setSampleRate (double rate);
+
+      /**
+         @brief Returns the sample rate in Hz.
+      */
+      double sampleRate() const;
+
+      /**
+         @brief Sets the number of samples sent in each bus transfer.
+
+         Only used when a single channel is played, the default is 1.
+         @return false if the player is running or n is null.
+      */
+      bool setSamplesPerTransfer (int n);
+
+      /**
+         @brief Returns the number of samples sent in each bus transfer.
+      */
+      int samplesPerTransfer() const;
+
+      /**
+         @brief Starts the playback from the beginning of the tables.
+         @return false if the converter is not opened for writing or there is no table.
+      */
+      bool start();
+
+      /**
+         @brief Stops the playback.
+      */
+      void stop();
+
+      /**
+         @brief Returns true if the playback is running.
+      */
+      bool isRunning() const;
+
+      /**
+         @brief Returns the sample rate measured since the start, in Hz.
+      */
+      double achievedRate() const;
+
+      /**
+         @brief Number of sample periods played since the start.
+      */
+      unsigned long samplesPlayed() const;
+
+      /**
+         @brief Number of samples written more than half a period after their
+         deadline, or skipped because the thread was late by more than one period.
+      */
+      unsigned long lateSamples() const;
+
+      /**
+         @brief Number of failed writes since the start.
+      */
+      unsigned long errors() const;
+
+    protected:
+      class Private;
+      WaveformPlayer (Private &dd);
+      std::shared_ptr<Private> d_ptr;
+
+    private:
+      PIMP_DECLARE_PRIVATE (WaveformPlayer)
+  };
+}
+/* ========================================================================== */
@@ -16,6 +16,7 @@
 */
 #include <iostream>
 #include <iomanip>
+#include <cstddef>
 #include <exception>
 #include <piduino/gpio.h>
 #include <piduino/clock.h>
@@ -53,7 +54,7 @@ namespace Piduino {
   // -------------------------------------------------------------------------
   unsigned int
   AllWinnerHxGpio::flags() const {
-    return  hasPullRead | hasToggle | hasDrive;
+    return  hasPullRead | hasToggle | hasDrive | hasPortAccess;
   }
 
   // -------------------------------------------------------------------------
@@ -257,6 +258,22 @@ namespace Piduino {
     return b->DAT & (1 << g) ? true : false;
   }
 
+  // -------------------------------------------------------------------------
+  bool
+  AllWinnerHxGpio::portAccess (const Pin *pin, Pin::Port &port) const {
+    PIMP_D (const AllWinnerHxGpio);
+    Private::PioBank *b;
+    int g = pin->mcuNumber();
+
+    b = d->pinBank (&g);
+    // data register only, written by read-modify-write
+    port.set = nullptr;
+    port.clr = nullptr;
+    port.dat = reinterpret_cast<volatile uint32_t *> (reinterpret_cast<uint8_t *> (b) + offsetof (Private::PioBank, DAT));
+    port.mask = 1 << g;
+    return true;
+  }
+
   // -------------------------------------------------------------------------
   int
   AllWinnerHxGpio::drive (const Pin *pin) const {
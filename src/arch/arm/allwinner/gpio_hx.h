@@ -46,6 +46,7 @@ namespace Piduino {
       Pin::Pull pull (const Pin *pin) const;
       void setDrive (const Pin *pin, int d);
       int drive (const Pin *pin) const;
+      bool portAccess (const Pin *pin, Pin::Port &port) const;
 
       const std::map<Pin::Mode, std::string> &modes() const;
 
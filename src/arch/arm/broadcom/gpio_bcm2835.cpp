@@ -52,7 +52,7 @@ namespace Piduino {
   // -------------------------------------------------------------------------
   unsigned int
   Bcm2835Gpio::flags() const {
-    return  hasAltRead | (Private::is2711  ? hasPullRead : 0);
+    return  hasAltRead | hasPortAccess | (Private::is2711  ? hasPullRead : 0);
   }
 
   // -------------------------------------------------------------------------
@@ -287,6 +287,25 @@ namespace Piduino {
     return (d->iomap.atomicRead (offset) & (1 << g)) != 0;
   }
 
+  // -------------------------------------------------------------------------
+  bool
+  Bcm2835Gpio::portAccess (const Pin *pin, Pin::Port &port) const {
+    PIMP_D (const Bcm2835Gpio);
+    unsigned int bank = 0;
+    int g = pin->mcuNumber();
+
+    if (g > 31) {
+
+      bank++;
+      g -= 32;
+    }
+    port.set = d->iomap.io (GPSET0 + bank);
+    port.clr = d->iomap.io (GPCLR0 + bank);
+    port.dat = d->iomap.io (GPLEV0 + bank);
+    port.mask = 1 << g;
+    return true;
+  }
+
   // -------------------------------------------------------------------------
   const std::map<Pin::Mode, std::string> &
   Bcm2835Gpio::modes() const {
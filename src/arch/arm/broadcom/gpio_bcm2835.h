@@ -44,6 +44,7 @@ namespace Piduino {
       bool read (const Pin *pin) const;
       Pin::Mode mode (const Pin *pin) const;
       Pin::Pull pull (const Pin *pin) const;
+      bool portAccess (const Pin *pin, Pin::Port &port) const;
 
       const std::map<Pin::Mode, std::string> &modes() const;
 
@@ -252,6 +252,18 @@ namespace Piduino {
     return !! (d->rio[GPIO_RIO_IN] & (1 << pin->mcuNumber()));
   }
 
+  // -------------------------------------------------------------------------
+  bool
+  Rp1Gpio::portAccess (const Pin *pin, Pin::Port &port) const {
+    PIMP_D (const Rp1Gpio);
+
+    port.set = &d->rio[GPIO_RIO_OUT + GPIO_RIO_SET_OFFSET];
+    port.clr = &d->rio[GPIO_RIO_OUT + GPIO_RIO_CLR_OFFSET];
+    port.dat = &d->rio[GPIO_RIO_IN];
+    port.mask = 1 << pin->mcuNumber();
+    return true;
+  }
+
   // -------------------------------------------------------------------------
   const std::map<Pin::Mode, std::string> &
   Rp1Gpio::modes() const {
@@ -368,7 +380,7 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   Rp1Gpio::Private::Private (Rp1Gpio *q) :
-    GpioDevice::Private (q), flags (hasAltRead | hasPullRead | hasDrive | hasToggle) {
+    GpioDevice::Private (q), flags (hasAltRead | hasPullRead | hasDrive | hasToggle | hasPortAccess) {
 
   }
 
@@ -59,6 +59,9 @@ namespace Piduino {
       void setDrive (const Pin *pin, int d);
       int drive (const Pin *pin) const;
 
+      // may be redefined, in this case set the flag hasPortAccess
+      bool portAccess (const Pin *pin, Pin::Port &port) const;
+
     protected:
       // do not remove the following lines
       // they are used for the private implementation idiom
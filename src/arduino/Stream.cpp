@@ -26,32 +26,62 @@
 #include "Stream.h"
 
 #define PARSE_TIMEOUT 1000  // default number of milli-seconds to wait
+#define CHUNK_SIZE 64       // number of bytes processed at once by the parsing methods
 
-// protected method to read stream with timeout
-int Stream::timedRead() {
-  int c;
+// protected method to wait for data with timeout
+// polls available() with a short sleep, so that a waiting thread does not
+// use a whole core, Terminal overrides it with a blocking wait
+bool Stream::waitForData (unsigned long msTimeout) {
   unsigned long startMillis = millis();
-  do {
-    c = read();
+
+  while (available() <= 0) {
+    if (millis() - startMillis >= msTimeout) {
+      return false;
+    }
+    delay (1);
+  }
+  return true;
+}
+
+// protected method to peek the available bytes without waiting
+// peek() only gives the next byte
+size_t Stream::peekAvailable (char *buffer, size_t length) {
+  if (length > 0) {
+    int c = peek();
     if (c >= 0) {
-      return c;
+      *buffer = (char) c;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// protected method to read the available bytes without waiting
+size_t Stream::readAvailable (char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length && available() > 0) {
+    int c = read();
+    if (c < 0) {
+      break;
     }
+    buffer[count++] = (char) c;
+  }
+  return count;
+}
+
+// protected method to read stream with timeout
+int Stream::timedRead() {
+  if (waitForData (_timeout)) {
+    return read();
   }
-  while (millis() - startMillis < _timeout);
   return -1;     // -1 indicates timeout
 }
 
 // protected method to peek stream with timeout
 int Stream::timedPeek() {
-  int c;
-  unsigned long startMillis = millis();
-  do {
-    c = peek();
-    if (c >= 0) {
-      return c;
-    }
+  if (waitForData (_timeout)) {
+    return peek();
   }
-  while (millis() - startMillis < _timeout);
   return -1;     // -1 indicates timeout
 }
 
@@ -222,13 +252,12 @@ float Stream::parseFloat (LookaheadMode lookahead, char ignore) {
 //
 size_t Stream::readBytes (char *buffer, size_t length) {
   size_t count = 0;
-  while (count < length) {
-    int c = timedRead();
-    if (c < 0) {
+  while (count < length && waitForData (_timeout)) {
+    size_t n = readAvailable (buffer + count, length - count);
+    if (n == 0) {
       break;
     }
-    *buffer++ = (char) c;
-    count++;
+    count += n;
   }
   return count;
 }
@@ -243,33 +272,54 @@ size_t Stream::readBytesUntil (char terminator, char *buffer, size_t length) {
     return 0;
   }
   size_t index = 0;
-  while (index < length) {
-    int c = timedRead();
-    if (c < 0 || c == terminator) {
+  while (index < length && waitForData (_timeout)) {
+    size_t n = peekAvailable (buffer + index, length - index);
+    if (n == 0) {
+      break;
+    }
+    char *t = (char *) memchr (buffer + index, terminator, n);
+    if (t) {
+      n = t - (buffer + index);
+      readAvailable (buffer + index, n + 1); // the terminator is discarded
+      index += n;
       break;
     }
-    *buffer++ = (char) c;
-    index++;
+    readAvailable (buffer + index, n);
+    index += n;
   }
   return index; // return number of characters, not including null terminator
 }
 
 String Stream::readString() {
   String ret;
-  int c = timedRead();
-  while (c >= 0) {
-    ret += (char) c;
-    c = timedRead();
+  char chunk[CHUNK_SIZE];
+  while (waitForData (_timeout)) {
+    size_t n = readAvailable (chunk, sizeof (chunk));
+    if (n == 0) {
+      break;
+    }
+    ret.append (chunk, n);
   }
   return ret;
 }
 
 String Stream::readStringUntil (char terminator) {
   String ret;
-  int c = timedRead();
-  while (c >= 0 && c != terminator) {
-    ret += (char) c;
-    c = timedRead();
+  char chunk[CHUNK_SIZE];
+  while (waitForData (_timeout)) {
+    size_t n = peekAvailable (chunk, sizeof (chunk));
+    if (n == 0) {
+      break;
+    }
+    char *t = (char *) memchr (chunk, terminator, n);
+    if (t) {
+      n = t - chunk;
+      ret.append (chunk, n);
+      readAvailable (chunk, n + 1); // the terminator is discarded
+      break;
+    }
+    ret.append (chunk, n);
+    readAvailable (chunk, n);
   }
   return ret;
 }
@@ -283,66 +333,77 @@ int Stream::findMulti (struct Stream::MultiTarget *targets, int tCount) {
     }
   }
 
-  while (1) {
-    int c = timedRead();
-    if (c < 0) {
-      return -1;
+  char chunk[CHUNK_SIZE];
+  while (waitForData (_timeout)) {
+    size_t n = peekAvailable (chunk, sizeof (chunk));
+    if (n == 0) {
+      break;
     }
-
-    for (struct MultiTarget *t = targets; t < targets + tCount; ++t) {
-      // the simple case is if we match, deal with that first.
-      if (c == t->str[t->index]) {
-        if (++t->index == t->len) {
-          return t - targets;
-        }
-        else {
-          continue;
-        }
+    for (size_t i = 0; i < n; i++) {
+      int found = matchMulti (targets, tCount, chunk[i]);
+      if (found >= 0) {
+        readAvailable (chunk, i + 1); // the bytes after the target are left in the stream
+        return found;
       }
+    }
+    readAvailable (chunk, n);
+  }
+  return -1;
+}
 
-      // if not we need to walk back and see if we could have matched further
-      // down the stream (ie '1112' doesn't match the first position in '11112'
-      // but it will match the second position so we can't just reset the current
-      // index to 0 when we find a mismatch.
-      if (t->index == 0) {
+int Stream::matchMulti (struct Stream::MultiTarget *targets, int tCount, char c) {
+  for (struct MultiTarget *t = targets; t < targets + tCount; ++t) {
+    // the simple case is if we match, deal with that first.
+    if (c == t->str[t->index]) {
+      if (++t->index == t->len) {
+        return t - targets;
+      }
+      else {
         continue;
       }
+    }
 
-      int origIndex = t->index;
-      do {
-        --t->index;
-        // first check if current char works against the new current index
-        if (c != t->str[t->index]) {
-          continue;
-        }
+    // if not we need to walk back and see if we could have matched further
+    // down the stream (ie '1112' doesn't match the first position in '11112'
+    // but it will match the second position so we can't just reset the current
+    // index to 0 when we find a mismatch.
+    if (t->index == 0) {
+      continue;
+    }
 
-        // if it's the only char then we're good, nothing more to check
-        if (t->index == 0) {
-          t->index++;
-          break;
-        }
+    int origIndex = t->index;
+    do {
+      --t->index;
+      // first check if current char works against the new current index
+      if (c != t->str[t->index]) {
+        continue;
+      }
 
-        // otherwise we need to check the rest of the found string
-        int diff = origIndex - t->index;
-        size_t i;
-        for (i = 0; i < t->index; ++i) {
-          if (t->str[i] != t->str[i + diff]) {
-            break;
-          }
-        }
+      // if it's the only char then we're good, nothing more to check
+      if (t->index == 0) {
+        t->index++;
+        break;
+      }
 
-        // if we successfully got through the previous loop then our current
-        // index is good.
-        if (i == t->index) {
-          t->index++;
+      // otherwise we need to check the rest of the found string
+      int diff = origIndex - t->index;
+      size_t i;
+      for (i = 0; i < t->index; ++i) {
+        if (t->str[i] != t->str[i + diff]) {
           break;
         }
+      }
 
-        // otherwise we just try the next index
+      // if we successfully got through the previous loop then our current
+      // index is good.
+      if (i == t->index) {
+        t->index++;
+        break;
       }
-      while (t->index);
+
+      // otherwise we just try the next index
     }
+    while (t->index);
   }
-  // unreachable
   return -1;
 }
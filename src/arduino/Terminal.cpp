@@ -93,6 +93,25 @@ int Terminal::timedPeek() {
   return -1;
 }
 
+// -----------------------------------------------------------------------------
+// sleeps on the condition variable of the receive buffer
+bool Terminal::waitForData (unsigned long msTimeout) {
+
+  return notifier().views (msTimeout).total() > 0;
+}
+
+// -----------------------------------------------------------------------------
+size_t Terminal::peekAvailable (char *buffer, size_t length) {
+
+  return notifier().peek (buffer, length);
+}
+
+// -----------------------------------------------------------------------------
+size_t Terminal::readAvailable (char *buffer, size_t length) {
+
+  return notifier().read (buffer, length);
+}
+
 // -----------------------------------------------------------------------------
 size_t Terminal::write (uint8_t c) {
 
@@ -14,14 +14,368 @@
  * You should have received a copy of the GNU Lesser General Public License
  * along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
  */
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
 #include <HardwareSerial.h>
 #include <Arduino.h>
 #include <piduino/database.h>
+#include "ioreactor.h"
 
 using namespace Piduino;
 using namespace std;
 
-std::deque<HardwareSerial> HardwareSerial::availablePorts;
+// -----------------------------------------------------------------------------
+//
+//                         HardwareSerial::TxBuffer Class
+//
+// -----------------------------------------------------------------------------
+class HardwareSerial::TxBuffer {
+  public:
+    TxBuffer() : fd (-1), tfd (-1), port (nullptr), len (0), data (1024),
+      policy (FlushOnNewline | FlushOnTimer), timeout (10), maxPending (0), armed (false) {}
+
+    ~TxBuffer() {
+      close();
+    }
+
+    void open (SerialPort * p);
+    void close();
+    ssize_t write (const char * buf, size_t n, bool endl = false);
+    bool flush();
+    void resize (size_t size);
+
+    int fd;
+    int tfd; ///< timerfd of the FlushOnTimer policy, served by the reactor
+    SerialPort * port;
+    size_t len;
+    std::vector<char> data;
+    int policy;
+    unsigned long timeout; ///< ms
+    size_t maxPending;
+    std::atomic<bool> armed; ///< also re-armed by onTimer() without the mutex
+    std::mutex mutex;
+
+  private:
+    // mutex must be locked
+    bool flushLocked (const char * buf = nullptr, size_t n = 0, bool endl = false);
+    bool writeAll (struct iovec * iov, int iovcnt);
+    void waitRoom (size_t n);
+    size_t pending() const;
+    bool isRs485() const;
+    void arm (unsigned long us);
+    void disarm();
+    // called by the thread of the reactor
+    void onTimer();
+};
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::TxBuffer::open (SerialPort * p) {
+
+  if (tfd < 0) {
+    auto handler = [this] (uint32_t) {
+      onTimer();
+    };
+
+    tfd = ::timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd >= 0 && !IoReactor::shared().add (tfd, handler)) {
+      // without timer, the buffer is written by the other policies only
+      ::close (tfd);
+      tfd = -1;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock (mutex);
+  port = p;
+  fd = p->fd();
+  len = 0;
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::TxBuffer::close() {
+
+  if (tfd >= 0) {
+
+    // on return, onTimer() is no longer called
+    IoReactor::shared().remove (tfd);
+    ::close (tfd);
+    tfd = -1;
+  }
+
+  std::lock_guard<std::mutex> lock (mutex);
+  if (fd >= 0) {
+
+    flushLocked();
+    fd = -1;
+  }
+  port = nullptr;
+  armed = false;
+}
+
+// -----------------------------------------------------------------------------
+ssize_t HardwareSerial::TxBuffer::write (const char * buf, size_t n, bool endl) {
+  std::lock_guard<std::mutex> lock (mutex);
+  size_t total = n + (endl ? 2 : 0);
+
+  if (fd < 0) {
+
+    return -1;
+  }
+
+  if (len + total > data.size()) {
+
+    // the buffer and the data are written together, without copy
+    return flushLocked (buf, n, endl) ? total : -1;
+  }
+
+  memcpy (&data[len], buf, n);
+  len += n;
+  if (endl) {
+
+    memcpy (&data[len], "\r\n", 2);
+    len += 2;
+  }
+
+  if ( (len == data.size()) ||
+       ( (policy & FlushOnNewline) && (endl || memchr (buf, '\n', n)))) {
+
+    return flushLocked() ? total : -1;
+  }
+
+  // the reactor does not write the RS485 frames, see onTimer()
+  if ( (policy & FlushOnTimer) && !armed && !isRs485()) {
+
+    arm (timeout * 1000);
+  }
+  return total;
+}
+
+// -----------------------------------------------------------------------------
+bool HardwareSerial::TxBuffer::flush() {
+  std::lock_guard<std::mutex> lock (mutex);
+
+  return (fd < 0) || flushLocked();
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::TxBuffer::resize (size_t size) {
+  std::lock_guard<std::mutex> lock (mutex);
+
+  if (fd >= 0) {
+
+    flushLocked();
+  }
+  len = 0;
+  data.resize (std::max (size, static_cast<size_t> (1)));
+}
+
+// -----------------------------------------------------------------------------
+bool HardwareSerial::TxBuffer::flushLocked (const char * buf, size_t n, bool endl) {
+  struct iovec iov[3];
+  int cnt = 0;
+  size_t total = 0;
+
+  if (len) {
+
+    iov[cnt].iov_base = data.data();
+    iov[cnt++].iov_len = len;
+    total += len;
+  }
+  if (n) {
+
+    iov[cnt].iov_base = const_cast<char *> (buf);
+    iov[cnt++].iov_len = n;
+    total += n;
+  }
+  if (endl) {
+
+    iov[cnt].iov_base = const_cast<char *> ("\r\n");
+    iov[cnt++].iov_len = 2;
+    total += 2;
+  }
+  len = 0;
+  disarm();
+
+  if (cnt == 0) {
+
+    return true;
+  }
+
+  if (isRs485()) {
+
+    // SerialPort drives RTS around each write
+    for (int i = 0; i < cnt; i++) {
+
+      if (port->write (static_cast<const char *> (iov[i].iov_base), iov[i].iov_len) < 0) {
+
+        return false;
+      }
+    }
+    return true;
+  }
+
+  waitRoom (total);
+  return writeAll (iov, cnt);
+}
+
+// -----------------------------------------------------------------------------
+// the port is opened with O_NONBLOCK
+bool HardwareSerial::TxBuffer::writeAll (struct iovec * iov, int iovcnt) {
+
+  while (iovcnt > 0) {
+    ssize_t ret = ::writev (fd, iov, iovcnt);
+
+    if (ret < 0) {
+
+      if (errno == EAGAIN || errno == EINTR) {
+        struct pollfd p = { fd, POLLOUT, 0 };
+
+        ::poll (&p, 1, -1);
+        continue;
+      }
+      return false;
+    }
+
+    while (iovcnt > 0 && static_cast<size_t> (ret) >= iov->iov_len) {
+
+      ret -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+
+      iov->iov_base = static_cast<char *> (iov->iov_base) + ret;
+      iov->iov_len -= ret;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// sleeps for the time the driver needs to send the excess of its output queue
+void HardwareSerial::TxBuffer::waitRoom (size_t n) {
+
+  if (maxPending) {
+    unsigned long byteTime = port->settings().onebyteTime;
+
+    for (;;) {
+      size_t q = pending();
+
+      if (q == 0 || q + n <= maxPending) {
+
+        break;
+      }
+      delayMicroseconds (std::min (q + n - maxPending, q) * byteTime);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+size_t HardwareSerial::TxBuffer::pending() const {
+  int q;
+
+  if (::ioctl (fd, TIOCOUTQ, &q) < 0) {
+
+    return 0;
+  }
+  return q;
+}
+
+// -----------------------------------------------------------------------------
+bool HardwareSerial::TxBuffer::isRs485() const {
+  SerialPort::FlowControl f = port->flowControl();
+
+  return f == SerialPort::Rs485RtsUpControl || f == SerialPort::Rs485RtsDownControl;
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::TxBuffer::arm (unsigned long us) {
+
+  if (tfd >= 0) {
+    struct itimerspec its = {};
+
+    its.it_value.tv_sec = us / 1000000;
+    its.it_value.tv_nsec = (us % 1000000) * 1000;
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) {
+      // a null value disarms the timer
+      its.it_value.tv_nsec = 1000;
+    }
+    armed = (::timerfd_settime (tfd, 0, &its, nullptr) == 0);
+  }
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::TxBuffer::disarm() {
+
+  if (armed) {
+    struct itimerspec its = {};
+
+    ::timerfd_settime (tfd, 0, &its, nullptr);
+    armed = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// must not block, the reactor serves the other terminals
+void HardwareSerial::TxBuffer::onTimer() {
+  uint64_t expirations;
+
+  if (::read (tfd, &expirations, sizeof (expirations)) < 0) {
+    // disarmed before the event was served
+  }
+
+  // the mutex is held by write() and flush() while they wait for the driver
+  std::unique_lock<std::mutex> lock (mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+
+    arm (timeout * 1000);
+    return;
+  }
+
+  armed = false;
+  // the RS485 frames are written by the caller (flush() or newline), here
+  // SerialPort would wait for the whole frame to be sent
+  if (fd < 0 || len == 0 || isRs485()) {
+
+    return;
+  }
+
+  if (maxPending) {
+    size_t q = pending();
+
+    if (q > 0 && q + len > maxPending) {
+
+      // tried again when the driver has sent the excess
+      arm (std::min (q + len - maxPending, q) * port->settings().onebyteTime);
+      return;
+    }
+  }
+
+  ssize_t ret = ::write (fd, data.data(), len);
+  if (ret > 0) {
+
+    len -= ret;
+    memmove (&data[0], &data[ret], len);
+  }
+  if (len) {
+
+    arm (timeout * 1000);
+  }
+}
+
+// -----------------------------------------------------------------------------
+//
+//                             HardwareSerial Class
+//
+// -----------------------------------------------------------------------------
+// the slots are created unbound, no port is enumerated before the first use
+std::deque<HardwareSerial> HardwareSerial::availablePorts = HardwareSerial::createSlots();
 
 HardwareSerial & Serial  = HardwareSerial::availablePorts[0];
 HardwareSerial & Serial1 = HardwareSerial::availablePorts[1];
@@ -33,46 +387,78 @@ HardwareSerial & Serial6 = HardwareSerial::availablePorts[6];
 HardwareSerial & Serial7 = HardwareSerial::availablePorts[7];
 
 // -----------------------------------------------------------------------------
-void HardwareSerial::setupAvailablePorts() {
-  int n;
-  auto ports = SerialPort::Info::availablePorts();
+std::deque<HardwareSerial> HardwareSerial::createSlots() {
+  std::deque<HardwareSerial> slots;
+
+  for (int n = 0; n < numberOfPorts; n++) {
+
+    slots.push_back (HardwareSerial (n));
+  }
+  return slots;
+}
+
+// -----------------------------------------------------------------------------
+// Serial is the default port, Serial1... the other ports in the order of
+// the enumeration, the missing ports are the default port so that Serial1,
+// Serial2, and Serial3 are always valid
+SerialPort::Info HardwareSerial::slotPort (int slot) {
   auto defaultPort = SerialPort::Info::defaultPort();
 
-  availablePorts.push_back (HardwareSerial (defaultPort));
-  n = 1;
+  if (slot > 0) {
+    int n = 1;
 
-  for (auto & p : ports) {
+    for (auto & p : SerialPort::Info::availablePorts()) {
 
-    if (n >= numberOfPorts) {
+      if (p != defaultPort) {
 
-      break;
-    }
-    if (p != defaultPort) {
+        if (n == slot) {
 
-      availablePorts.push_back (HardwareSerial (p));
-      n++;
+          return p;
+        }
+        n++;
+      }
     }
   }
-  // fill in the missing ports with the default port
-  // so that Serial1, Serial2, and Serial3 are always valid
-  for (; n < numberOfPorts; n++) {
-    availablePorts.push_back (HardwareSerial (defaultPort));
+  return defaultPort;
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::bind() const {
+
+  if (_slot >= 0) {
+
+    port->setPort (slotPort (_slot));
+    _slot = -1;
+  }
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::setupAvailablePorts() {
+
+  for (auto & s : availablePorts) {
+
+    s.bind();
   }
 }
 
 // -----------------------------------------------------------------------------
 HardwareSerial::HardwareSerial () :
-  port (new Piduino::SerialPort ()), _writelnDelay (0) {
+  port (new Piduino::SerialPort ()), tx (new TxBuffer), _writelnDelay (0), _slot (-1) {
+}
+
+// -----------------------------------------------------------------------------
+HardwareSerial::HardwareSerial (int slot) :
+  port (new Piduino::SerialPort ()), tx (new TxBuffer), _writelnDelay (0), _slot (slot) {
 }
 
 // -----------------------------------------------------------------------------
 HardwareSerial::HardwareSerial (const Piduino::SerialPort::Info & serialPortInfo) :
-  port (new Piduino::SerialPort (serialPortInfo)), _writelnDelay (0) {
+  port (new Piduino::SerialPort (serialPortInfo)), tx (new TxBuffer), _writelnDelay (0), _slot (-1) {
 }
 
 // -----------------------------------------------------------------------------
 HardwareSerial::HardwareSerial (const String & path) :
-  port (new Piduino::SerialPort (path)), _writelnDelay (0) {
+  port (new Piduino::SerialPort (path)), tx (new TxBuffer), _writelnDelay (0), _slot (-1) {
 }
 
 // -----------------------------------------------------------------------------
@@ -81,7 +467,8 @@ HardwareSerial::~HardwareSerial() = default;
 // -----------------------------------------------------------------------------
 void HardwareSerial::begin (unsigned long baud, uint8_t config) {
   SerialPort::Settings s (port->settings());
-  
+
+  bind();
   Terminal::begin();
   switch (config) {
     case SERIAL_5N1:
@@ -184,17 +571,16 @@ void HardwareSerial::begin (unsigned long baud, uint8_t config) {
   port->setBaudRate (baud);
   if (port->open (IoDevice::ReadWrite | IoDevice::Binary)) {
     Terminal::begin();
-    if (portName().startsWith ("ttyS")  &&
-        (db.board().soc().family().id() == SoC::Family::AllwinnerH)) {
-
-      _writelnDelay = 500; // to avoid buffer overflow on SoC Allwinner
-      // TODO: Analyze the sun8i driver code to understand why this is needed !
-    }
-    else if (portName().startsWith ("ttyAMA")  &&
-             (db.board().soc().family().id() == SoC::Family::BroadcomBcm2835)) {
-
-      _writelnDelay = 4000; // to avoid buffer overflow on Bcm2835
-      // TODO: Analyze the Bcm2835 driver code to understand why this is needed !
+    tx->open (port.get());
+    if ( (portName().startsWith ("ttyS")  &&
+          (db.board().soc().family().id() == SoC::Family::AllwinnerH)) ||
+         (portName().startsWith ("ttyAMA")  &&
+          (db.board().soc().family().id() == SoC::Family::BroadcomBcm2835))) {
+
+      // to avoid buffer overflow on the SoC Allwinner and Bcm2835, the output
+      // queue of the driver is kept short instead of sleeping after each line
+      setMaxPending (256);
+      // TODO: Analyze the sun8i and Bcm2835 driver code to understand why this is needed !
     }
   }
   else {
@@ -222,6 +608,7 @@ void HardwareSerial::begin (unsigned long baud, const char * name, uint8_t confi
 // -----------------------------------------------------------------------------
 void HardwareSerial::end() {
 
+  tx->close();
   Terminal::end();
   port->close();
 }
@@ -242,47 +629,111 @@ Piduino::TerminalNotifier & HardwareSerial::notifier() {
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::writeln() {
-  
-  size_t ret = write ("\r\n");
-  flush();
-  delayMicroseconds (_writelnDelay);
+
+  size_t ret = tx->write ("\r\n", 2);
+  if (_writelnDelay) {
+
+    delayMicroseconds (_writelnDelay);
+  }
   return ret;
 }
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::write (uint8_t c) {
 
-  return port->write(reinterpret_cast <const char *>(&c), 1);
+  return tx->write (reinterpret_cast <const char *> (&c), 1);
 }
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::write (const String & str) {
 
-  return port->write(str.c_str(), str.length());
+  return tx->write (str.c_str(), str.length());
 }
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::write (const uint8_t *buffer, size_t size) {
 
-  return port->write(reinterpret_cast <const char *>(buffer), size);
+  return tx->write (reinterpret_cast <const char *> (buffer), size);
 }
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::writeln (uint8_t c) {
 
-  return port->write(reinterpret_cast <const char *>(&c), 1, true);
+  return tx->write (reinterpret_cast <const char *> (&c), 1, true);
 }
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::writeln (const String & str) {
 
-  return port->write(str.c_str(), str.length(), true);
+  return tx->write (str.c_str(), str.length(), true);
 }
 
 // -----------------------------------------------------------------------------
 size_t HardwareSerial::writeln (const uint8_t *buffer, size_t size) {
 
-  return port->write(reinterpret_cast <const char *>(buffer), size, true);
+  return tx->write (reinterpret_cast <const char *> (buffer), size, true);
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::flush() {
+
+  if (!tx->flush()) {
+
+    setWriteError (errno);
+  }
+  // bytes written through os()
+  Terminal::flush();
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::setFlushPolicy (int policy) {
+  std::lock_guard<std::mutex> lock (tx->mutex);
+
+  tx->policy = policy;
+}
+
+// -----------------------------------------------------------------------------
+int HardwareSerial::flushPolicy() const {
+
+  return tx->policy;
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::setFlushTimeout (unsigned long ms) {
+  std::lock_guard<std::mutex> lock (tx->mutex);
+
+  tx->timeout = ms;
+}
+
+// -----------------------------------------------------------------------------
+unsigned long HardwareSerial::flushTimeout() const {
+
+  return tx->timeout;
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::setOutputBufferSize (size_t size) {
+
+  tx->resize (size);
+}
+
+// -----------------------------------------------------------------------------
+size_t HardwareSerial::outputBufferSize() const {
+
+  return tx->data.size();
+}
+
+// -----------------------------------------------------------------------------
+void HardwareSerial::setMaxPending (size_t bytes) {
+  std::lock_guard<std::mutex> lock (tx->mutex);
+
+  tx->maxPending = bytes;
+}
+
+// -----------------------------------------------------------------------------
+size_t HardwareSerial::maxPending() const {
+
+  return tx->maxPending;
 }
 
 /* ========================================================================== */
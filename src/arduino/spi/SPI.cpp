@@ -107,8 +107,10 @@ void SPIClass::end() {
 // and configure the correct settings.
 void SPIClass::beginTransaction (const SPISettings &s) {
 
+  // the lock is shared by all the SpiDev opened on the same bus,
+  // the settings are applied by the first transfer if they differ
+  Piduino::SpiDev::beginTransaction();
   setSettings (s);
-  _pendingTransaction.lock();
 }
 
 // -----------------------------------------------------------------------------
@@ -116,7 +118,7 @@ void SPIClass::beginTransaction (const SPISettings &s) {
 // signal, this function allows others to access the SPI bus
 void SPIClass::endTransaction (void) {
 
-  _pendingTransaction.unlock();
+  Piduino::SpiDev::endTransaction();
 }
 
 // -----------------------------------------------------------------------------
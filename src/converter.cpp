@@ -16,7 +16,9 @@
 */
 #include <iostream>
 #include <piduino/converter.h>
+#include <piduino/scheduler.h>
 #include "converter_p.h"
+#include "precisetimer.h"
 #include "config.h"
 #include <functional>
 #include <map>
@@ -100,7 +102,19 @@ namespace Piduino {
     if (!isOpen()) {
       PIMP_D (Converter);
 
-      return d->open (mode);
+      if (d->open (mode)) {
+
+        d->invalidateScaling(); // the setup may have been read from the device
+
+        // rate= option of the parameter string
+        if (d->acqRate > 0 && !startAcquisition (d->acqRate, d->acqFirst, d->acqLast)) {
+
+          d->close();
+          return false;
+        }
+        return true;
+      }
+      return false;
     }
     return isOpen();
   }
@@ -112,6 +126,7 @@ namespace Piduino {
     if (isOpen()) {
       PIMP_D (Converter);
 
+      d->stopAcquisition();
       d->close();
     }
   }
@@ -123,6 +138,7 @@ namespace Piduino {
 
     if (openMode() & ReadOnly) {
       PIMP_D (Converter);
+      std::lock_guard<std::mutex> lock (d->ioMutex);
 
       return d->read();
     }
@@ -159,12 +175,67 @@ namespace Piduino {
 
     if (openMode() & ReadOnly) {
       PIMP_D (Converter);
+      std::lock_guard<std::mutex> lock (d->ioMutex);
 
       return d->readChannel (channel, differential);
     }
     return InvalidValue;
   }
 
+  // ---------------------------------------------------------------------------
+  // virtual
+  bool
+  Converter::readChannels (int first, int last, long *values, bool differential) {
+
+    if ( (openMode() & ReadOnly) && values && first >= 0 && last >= first) {
+      PIMP_D (Converter);
+      std::lock_guard<std::mutex> lock (d->ioMutex);
+
+      return d->readChannels (first, last, values, differential);
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  // virtual
+  bool
+  Converter::readBlock (int channel, long *values, size_t count, bool differential) {
+
+    if ( (openMode() & ReadOnly) && values && count > 0) {
+      PIMP_D (Converter);
+      std::lock_guard<std::mutex> lock (d->ioMutex);
+
+      return d->readBlock (channel, values, count, differential);
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  // virtual
+  bool
+  Converter::writeBlock (int channel, const long *values, size_t count, unsigned long period) {
+
+    if ( (openMode() & WriteOnly) && values && count > 0) {
+      PIMP_D (Converter);
+
+      return d->writeBlock (channel, values, count, period);
+    }
+    return false;
+  }
+
+  // -----------------------------------------------------------------------------
+  // virtual
+  bool
+  Converter::writeChannels (const long *values, unsigned long mask) {
+
+    if ( (openMode() & WriteOnly) && values) {
+      PIMP_D (Converter);
+
+      return d->writeChannels (values, mask);
+    }
+    return false;
+  }
+
   // -----------------------------------------------------------------------------
   // virtual
   double
@@ -202,15 +273,42 @@ namespace Piduino {
     return d->valueToDigital (value, differential, channel);
   }
 
+  // -----------------------------------------------------------------------------
+  // virtual
+  void
+  Converter::digitalToValue (const long *digitalValues, double *values, size_t count, int channel, bool differential) const {
+
+    if (digitalValues && values && count > 0) {
+      PIMP_D (const Converter);
+
+      d->digitalToValue (digitalValues, values, count, differential, channel);
+    }
+  }
+
+  // -----------------------------------------------------------------------------
+  // virtual
+  void
+  Converter::valueToDigital (const double *values, long *digitalValues, size_t count, int channel, bool differential) const {
+
+    if (digitalValues && values && count > 0) {
+      PIMP_D (const Converter);
+
+      d->valueToDigital (values, digitalValues, count, differential, channel);
+    }
+  }
+
   // -----------------------------------------------------------------------------
   // virtual
   double
   Converter::readAverage (int channel, bool differential, int count) {
-    double sum = 0.0;
-    for (int i = 0; i < count; ++i) {
-      sum += readChannel (channel, differential); // Read each sample
+
+    if ( (openMode() & ReadOnly) && count > 0) {
+      PIMP_D (Converter);
+      std::lock_guard<std::mutex> lock (d->ioMutex);
+
+      return d->readAverage (channel, differential, count);
     }
-    return sum / count;
+    return InvalidValue;
   }
 
   // -----------------------------------------------------------------------------
@@ -258,6 +356,118 @@ namespace Piduino {
     return writeChannel (valueToDigital (channel, value, differential), channel, differential);
   }
 
+  // ---------------------------------------------------------------------------
+  bool
+  Converter::startAcquisition (double rate, int first, int last, int capacity) {
+    PIMP_D (Converter);
+
+    if ( (openMode() & ReadOnly) && rate > 0 && first >= 0 && last >= first &&
+         last < numberOfChannels() && capacity > 0) {
+
+      return d->startAcquisition (rate, first, last, capacity);
+    }
+    d->setError (EINVAL);
+    if (d->isDebug) {
+      std::cerr << "Converter: invalid acquisition parameters or converter not opened for reading" << std::endl;
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::stopAcquisition() {
+    PIMP_D (Converter);
+
+    d->stopAcquisition();
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Converter::isAcquiring() const {
+    PIMP_D (const Converter);
+
+    auto acq = d->acquisition();
+
+    return acq && acq->isRunning();
+  }
+
+  // ---------------------------------------------------------------------------
+  double
+  Converter::acquisitionRate() const {
+    PIMP_D (const Converter);
+
+    auto acq = d->acquisition();
+
+    return acq && acq->isRunning() ? acq->rate : 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  int
+  Converter::readStream (Sample *buffer, int n) {
+    PIMP_D (Converter);
+    auto acq = d->acquisition();
+
+    if (acq) {
+
+      return (buffer && n > 0) ? static_cast<int> (acq->ring.pop (buffer, n)) : 0;
+    }
+    return -1;
+  }
+
+  // ---------------------------------------------------------------------------
+  int
+  Converter::streamAvailable() const {
+    PIMP_D (const Converter);
+    auto acq = d->acquisition();
+
+    return acq ? static_cast<int> (acq->ring.size()) : 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::attachStreamHandler (StreamHandler handler, void *userData) {
+    PIMP_D (Converter);
+    std::lock_guard<std::mutex> lock (d->handlerMutex);
+
+    d->streamHandler = handler;
+    d->streamUserData = userData;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::detachStreamHandler() {
+
+    attachStreamHandler (nullptr, nullptr);
+  }
+
+  // ---------------------------------------------------------------------------
+  Converter::AcquisitionStats
+  Converter::acquisitionStats() const {
+    PIMP_D (const Converter);
+    auto acq = d->acquisition();
+
+    if (acq) {
+      std::lock_guard<std::mutex> lock (acq->statsMutex);
+
+      return acq->stats;
+    }
+    return AcquisitionStats();
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::resetAcquisitionStats() {
+    PIMP_D (Converter);
+    auto acq = d->acquisition();
+
+    if (acq) {
+      std::lock_guard<std::mutex> lock (acq->statsMutex);
+
+      acq->stats = AcquisitionStats();
+      acq->jitterSum = 0;
+    }
+  }
+
   // ---------------------------------------------------------------------------
   // virtual
   int Converter::numberOfChannels() const {
@@ -334,7 +544,10 @@ namespace Piduino {
   int Converter::setResolution (int resolution) {
     PIMP_D (Converter);
 
-    return d->setResolution (resolution);
+    int result = d->setResolution (resolution);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -350,7 +563,10 @@ namespace Piduino {
   Converter::setBipolar (bool bipolar) {
     PIMP_D (Converter);
 
-    return d->setBipolar (bipolar);
+    bool result = d->setBipolar (bipolar);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -366,7 +582,10 @@ namespace Piduino {
   Converter::setRange (long range) {
     PIMP_D (Converter);
 
-    return d->setRange (range);
+    long result = d->setRange (range);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -374,7 +593,10 @@ namespace Piduino {
   Converter::setReference (int referenceId, double fsr) {
     PIMP_D (Converter);
 
-    return d->setReference (referenceId, fsr);
+    bool result = d->setReference (referenceId, fsr);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -382,7 +604,10 @@ namespace Piduino {
   Converter::setReference (int referenceId, int channel, double fsr) {
     PIMP_D (Converter);
 
-    return d->setReference (referenceId, fsr, channel);
+    bool result = d->setReference (referenceId, fsr, channel);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -421,7 +646,10 @@ namespace Piduino {
   bool Converter::setFullScaleRange (double fsr) {
     PIMP_D (Converter);
 
-    return d->setFullScaleRange (fsr);
+    bool result = d->setFullScaleRange (fsr);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -429,7 +657,10 @@ namespace Piduino {
   Converter::setFullScaleRange (int channel, double fsr) {
     PIMP_D (Converter);
 
-    return d->setFullScaleRange (fsr, channel);
+    bool result = d->setFullScaleRange (fsr, channel);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -471,7 +702,10 @@ namespace Piduino {
   bool Converter::setMode (Mode m, int channel) {
     PIMP_D (Converter);
 
-    return d->setMode (m, channel);
+    bool result = d->setMode (m, channel);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -479,7 +713,10 @@ namespace Piduino {
   Converter::setModeFlags (long flags, long mask, int channel) {
     PIMP_D (Converter);
 
-    return d->setModeFlags (flags, mask, channel);
+    bool result = d->setModeFlags (flags, mask, channel);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -487,7 +724,10 @@ namespace Piduino {
   Converter::clearModeFlags (long flags, long mask, int channel) {
     PIMP_D (Converter);
 
-    return d->clearModeFlags (flags, mask, channel);
+    bool result = d->clearModeFlags (flags, mask, channel);
+
+    d->invalidateScaling();
+    return result;
   }
 
   // ---------------------------------------------------------------------------
@@ -552,7 +792,48 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   Converter::Private::Private (Converter *q, Type type, unsigned int flags, const std::string &parameters) :
-    IoDevice::Private (q), type (type), flags (flags), parameters (split (parameters, ':')) {}
+    IoDevice::Private (q), type (type), flags (flags), parameters (split (parameters, ':')),
+    streamHandler (nullptr), streamUserData (nullptr), acqRate (0), acqFirst (0), acqLast (0) {
+
+    // The acquisition options are common to all the converters, they are
+    // removed before the subclass parses its own parameters.
+    auto it = this->parameters.begin();
+    while (it != this->parameters.end()) {
+
+      if (it->compare (0, 5, "rate=") == 0) {
+
+        try {
+
+          acqRate = std::stod (it->substr (5));
+        }
+        catch (std::exception &e) {
+
+          std::cerr << "Converter: Invalid acquisition rate specified: " << it->substr (5) << ". The acquisition will not be started." << std::endl;
+          acqRate = 0;
+        }
+        it = this->parameters.erase (it);
+      }
+      else if (it->compare (0, 5, "scan=") == 0) {
+        std::vector<std::string> range = split (it->substr (5), '-');
+
+        try {
+
+          acqFirst = std::stoi (range.at (0));
+          acqLast = (range.size() > 1) ? std::stoi (range[1]) : acqFirst;
+        }
+        catch (std::exception &e) {
+
+          std::cerr << "Converter: Invalid scan range specified: " << it->substr (5) << ". Using default value of 0." << std::endl;
+          acqFirst = acqLast = 0;
+        }
+        it = this->parameters.erase (it);
+      }
+      else {
+
+        ++it;
+      }
+    }
+  }
 
   // ---------------------------------------------------------------------------
   Converter::Private::~Private() = default;
@@ -611,6 +892,258 @@ namespace Piduino {
     return false;
   }
 
+  // ---------------------------------------------------------------------------
+  Converter::Private::Scaling
+  Converter::Private::scaling (int channel, bool differential) const {
+    size_t index = 2 * static_cast<size_t> (std::max (channel, 0)) + (differential ? 1 : 0);
+    unsigned long generation;
+    Scaling s;
+
+    {
+      std::lock_guard<std::mutex> lock (scalingMutex);
+
+      if (index < scalingCache.size() && scalingCache[index].valid) {
+
+        return scalingCache[index];
+      }
+      generation = scalingGeneration;
+    }
+
+    // the virtual functions are called without lock, they may access the device
+    s.fsr = fullScaleRange (channel);
+    s.range = static_cast<double> (range());
+    s.min = min (differential);
+    s.max = max (differential);
+    s.valid = true;
+
+    std::lock_guard<std::mutex> lock (scalingMutex);
+    if (generation == scalingGeneration) { // not invalidated meanwhile
+
+      if (index >= scalingCache.size()) {
+
+        scalingCache.resize (index + 1);
+      }
+      scalingCache[index] = s;
+    }
+    return s;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Converter::Private::writeBlock (int channel, const long *values, size_t count, unsigned long period) {
+    int64_t next = PreciseTimer::now();
+
+    for (size_t i = 0; i < count; i++) {
+
+      if (period > 0 && i > 0) {
+        // absolute deadlines, the time spent on the bus does not accumulate
+        next += static_cast<int64_t> (period) * 1000;
+        PreciseTimer::sleepTo (next);
+      }
+      if (!writeChannel (clampValue (values[i]), channel)) {
+
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Converter::Private::writeChannels (const long *values, unsigned long mask) {
+    const int n = std::min (numberOfChannels(), static_cast<int> (sizeof (mask) * 8));
+    bool success = true;
+
+    for (int channel = 0; channel < n; channel++) {
+
+      if (mask & (1UL << channel)) {
+
+        success = writeChannel (clampValue (values[channel]), channel) && success;
+      }
+    }
+    return success;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Converter::Private::startAcquisition (double rate, int first, int last, int capacity) {
+    std::lock_guard<std::mutex> control (acqControlMutex);
+    std::shared_ptr<Acquisition> previous = acquisition();
+
+    if (previous && previous->isRunning()) {
+
+      setError (EBUSY);
+      if (isDebug) {
+        std::cerr << "Converter: an acquisition is already running" << std::endl;
+      }
+      return false;
+    }
+
+    std::shared_ptr<Acquisition> next (new Acquisition (this, rate, first, last, capacity));
+    if (!next->start()) {
+
+      setError (EAGAIN);
+      if (isDebug) {
+        std::cerr << "Converter: unable to start the acquisition thread" << std::endl;
+      }
+      return false;
+    }
+
+    // the previous stream is released by its last reader
+    std::lock_guard<std::mutex> lock (acqMutex);
+    acq = next;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::Private::stopAcquisition() {
+    std::lock_guard<std::mutex> control (acqControlMutex);
+    std::shared_ptr<Acquisition> current = acquisition();
+
+    if (current) {
+
+      current->stop();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                     Converter::Private::Acquisition Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Converter::Private::Acquisition::Acquisition (Converter::Private *d, double rate, int first, int last, size_t capacity) :
+    d (d), rate (rate), first (first), last (last), period (static_cast<int64_t> (1e9 / rate)),
+    ring (capacity), running (false), stats(), jitterSum (0) {}
+
+  // ---------------------------------------------------------------------------
+  Converter::Private::Acquisition::~Acquisition() {
+
+    stop();
+    if (thread.joinable()) {
+
+      // the last reference was released by the thread itself
+      thread.detach();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Converter::Private::Acquisition::start() {
+
+    try {
+
+      running = true;
+      thread = std::thread (run, shared_from_this());
+    }
+    catch (std::system_error &e) {
+
+      running = false;
+      return false;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::Private::Acquisition::stop() {
+
+    running = false;
+    // called from the stream handler, the thread ends after its return
+    if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+
+      thread.join();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Converter::Private::Acquisition::run (std::shared_ptr<Acquisition> a) {
+    const int n = a->last - a->first + 1;
+    std::vector<long> values (n);
+    std::vector<Sample> samples (n);
+
+    try {
+      // below the software PWM generators (90)
+      Scheduler::setRtPriority (80);
+    }
+    catch (std::system_error &e) {
+
+      if (a->d->isDebug) {
+        std::cerr << "Converter: acquisition runs without real-time priority: " << e.what() << std::endl;
+      }
+    }
+    a->timer.calibrate (a->period / 2);
+
+    int64_t next = PreciseTimer::now() + a->period;
+    while (a->running) {
+      StreamHandler handler;
+      void *userData;
+      size_t pushed = 0;
+      bool success;
+
+      a->timer.sleepUntil (next);
+      int64_t start = PreciseTimer::now();
+      {
+        std::lock_guard<std::mutex> lock (a->d->ioMutex);
+
+        success = a->d->readChannels (a->first, a->last, values.data());
+      }
+
+      if (success) {
+
+        for (int i = 0; i < n; i++) {
+
+          samples[i].timestamp = start;
+          samples[i].channel = a->first + i;
+          samples[i].value = values[i];
+        }
+        pushed = a->ring.push (samples.data(), n);
+        {
+          std::lock_guard<std::mutex> lock (a->d->handlerMutex);
+
+          handler = a->d->streamHandler;
+          userData = a->d->streamUserData;
+        }
+        if (handler) {
+
+          handler (samples.data(), n, userData);
+        }
+      }
+
+      // a late scan is still performed, but the deadlines that have already
+      // been passed by more than one period are skipped
+      int64_t jitter = start - next;
+      unsigned long missed = 0;
+      int64_t late;
+
+      next += a->period;
+      late = PreciseTimer::now() - next;
+      if (late >= a->period) {
+
+        missed = static_cast<unsigned long> (late / a->period);
+        next += static_cast<int64_t> (missed) * a->period;
+      }
+
+      std::lock_guard<std::mutex> lock (a->statsMutex);
+      a->stats.scans++;
+      a->stats.missed += missed;
+      if (success) {
+
+        a->stats.overruns += n - pushed;
+      }
+      else {
+
+        a->stats.errors++;
+      }
+      a->jitterSum += jitter;
+      a->stats.meanJitter = a->jitterSum / a->stats.scans;
+      a->stats.maxJitter = std::max (a->stats.maxJitter, static_cast<long> (jitter));
+    }
+  }
+
   // -----------------------------------------------------------------------------
   // Converts a string to a vector of strings by splitting it at the given delimiter.
   // If skipEmpty is true, empty tokens are not included in the result.
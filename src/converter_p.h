@@ -19,8 +19,15 @@
 #include <iostream>
 #include <map>
 #include <climits>
+#include <algorithm>
 #include <cmath>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <piduino/converter.h>
+#include <piduino/spscring.h>
+#include "precisetimer.h"
 #include <piduino/gpio.h>
 #include "iodevice_p.h"
 
@@ -101,6 +108,109 @@ namespace Piduino {
         return read();
       }
 
+      /**
+         @brief Reads the values of a range of channels.
+         @param first The first channel to read.
+         @param last The last channel to read.
+         @param values Array receiving the last - first + 1 values.
+         @param differential If true, reads in differential mode (default is false).
+         @return true if all the channels were read, false otherwise.
+         @note The default implementation calls readChannel() for each channel,
+          may be overridden by subclasses with a hardware scan mode.
+          This function is not callable if the open mode is not ReadOnly or ReadWrite (or closed).
+      */
+      virtual bool readChannels (int first, int last, long *values, bool differential = false) {
+
+        for (int channel = first; channel <= last; channel++) {
+
+          values[channel - first] = readChannel (channel, differential);
+          if (values[channel - first] == InvalidValue) {
+
+            return false;
+          }
+        }
+        return true;
+      }
+
+      /**
+         @brief Reads a block of successive samples of a channel.
+         @param channel The channel to read from.
+         @param values Array receiving the samples.
+         @param count The number of samples to read.
+         @param differential If true, reads in differential mode (default is false).
+         @return true if all the samples were read, false otherwise.
+         @note The default implementation calls readChannel() for each sample,
+          may be overridden by subclasses able to read several samples per bus transaction.
+          This function is not callable if the open mode is not ReadOnly or ReadWrite (or closed).
+      */
+      virtual bool readBlock (int channel, long *values, size_t count, bool differential = false) {
+
+        for (size_t i = 0; i < count; i++) {
+
+          values[i] = readChannel (channel, differential);
+          if (values[i] == InvalidValue) {
+
+            return false;
+          }
+        }
+        return true;
+      }
+
+      /**
+         @brief Reads the average of count samples of a channel.
+         @param channel The channel to read from.
+         @param differential If true, reads in differential mode.
+         @param count The number of samples to average, greater than 0.
+         @return The average digital value, InvalidValue on error.
+         @note The default implementation accumulates the samples read by readBlock()
+          in chunks, may be overridden by subclasses with a hardware averaging mode.
+      */
+      virtual double readAverage (int channel, bool differential, int count) {
+        static const int ChunkSize = 32;
+        long chunk[ChunkSize];
+        long long sum = 0;
+
+        for (int done = 0; done < count;) {
+          int n = std::min (ChunkSize, count - done);
+
+          if (!readBlock (channel, chunk, n, differential)) {
+
+            return InvalidValue;
+          }
+          for (int i = 0; i < n; i++) {
+            sum += chunk[i];
+          }
+          done += n;
+        }
+        return static_cast<double> (sum) / count;
+      }
+
+      /**
+         @brief Writes a block of successive samples to a channel.
+         @param channel The channel to write to, -1 to all channels.
+         @param values Array of samples, they must be clamped by the implementation.
+         @param count The number of samples to write.
+         @param period Interval between two samples in microseconds, 0 to write as fast as possible.
+         @return true if all the samples were written, false otherwise.
+         @note The default implementation calls writeChannel() for each sample at
+          absolute deadlines, may be overridden by subclasses able to send several
+          samples per bus transaction.
+          This function is not callable if the open mode is not WriteOnly or ReadWrite (or closed).
+      */
+      virtual bool writeBlock (int channel, const long *values, size_t count, unsigned long period);
+
+      /**
+         @brief Writes several channels at once.
+         @param values Array indexed by channel number, they must be clamped by the implementation.
+         @param mask Selected channels, bit n for channel n.
+         @return true if all the selected channels were written, false otherwise.
+         @note The default implementation calls writeChannel() for each selected
+          channel, may be overridden by subclasses able to update several channels
+          in a single bus transaction.
+          This function is not callable if the open mode is not WriteOnly or ReadWrite (or closed).
+      */
+      virtual bool writeChannels (const long *values, unsigned long mask);
+
       /**
          @brief Writes a value to the converter device.
          @param value The value to write, this value will be clamped to the valid range.
@@ -317,6 +427,45 @@ namespace Piduino {
         return clampValue (result, differential);
       }
 
+      /**
+         @brief Converts an array of digital values to analog values.
+
+         The loop uses the coefficients cached by scaling() and gives the same
+         results as digitalToValue (long, bool, int), it has no call and no branch
+         so that the compiler can vectorize it.
+         @note must be overridden with the scalar version if a subclass overrides it.
+      */
+      virtual void digitalToValue (const long *digitalValues, double *values, size_t count, bool differential, int channel) const {
+        const Scaling s = scaling (channel, differential);
+        const double fsr = s.fsr;
+        const double r = s.range;
+
+        for (size_t i = 0; i < count; i++) {
+
+          values[i] = static_cast<double> (digitalValues[i]) * fsr / r;
+        }
+      }
+
+      /**
+         @brief Converts an array of analog values to clamped digital values.
+
+         Gives the same results as valueToDigital (double, bool, int), see digitalToValue().
+      */
+      virtual void valueToDigital (const double *values, long *digitalValues, size_t count, bool differential, int channel) const {
+        const Scaling s = scaling (channel, differential);
+        const double fsr = s.fsr;
+        const double r = s.range;
+        const long lo = s.min;
+        const long hi = s.max;
+
+        for (size_t i = 0; i < count; i++) {
+          long v = static_cast<long> ( (values[i] * r) / fsr);
+
+          v = v < lo ? lo : v;
+          digitalValues[i] = v > hi ? hi : v;
+        }
+      }
+
       /**
         @brief Gets the current clock frequency.
         @return The frequency in Hertz.
@@ -465,6 +614,93 @@ namespace Piduino {
       */
       static std::map<std::string, registryKey>   &getRegistry();
 
+      /**
+         @brief Background acquisition engine.
+
+         The thread scans the channels with readChannels() at the start of each
+         period, the deadlines are reached with a PreciseTimer. The samples are pushed
+         into a lock-free ring buffer, the only lock taken by the thread is ioMutex
+         during the scan, to serialize the bus accesses with the read functions.
+         The thread holds a reference to its acquisition, so that the stream
+         handler can stop or replace the acquisition from the thread itself.
+      */
+      class Acquisition : public std::enable_shared_from_this<Acquisition> {
+        public:
+          Acquisition (Converter::Private *d, double rate, int first, int last, size_t capacity);
+          ~Acquisition();
+
+          bool start();
+          void stop();
+          bool isRunning() const {
+            return running;
+          }
+
+          static void run (std::shared_ptr<Acquisition> a);
+
+          Converter::Private *d;
+          const double rate;
+          const int first;
+          const int last;
+          const int64_t period; ///< scan period in nanoseconds
+          PreciseTimer timer; ///< calibrated by the thread
+          SpscRing<Sample> ring;
+          std::atomic<bool> running;
+          std::thread thread;
+
+          mutable std::mutex statsMutex;
+          AcquisitionStats stats;
+          double jitterSum;
+      };
+
+      /**
+         @brief Starts the acquisition, fails with EBUSY if one is running.
+      */
+      bool startAcquisition (double rate, int first, int last, int capacity);
+
+      /**
+         @brief Stops the acquisition, the stream is kept until the next start.
+      */
+      void stopAcquisition();
+
+      /**
+         @brief Returns the current acquisition, it stays valid for the caller
+         even if a new acquisition replaces it.
+      */
+      std::shared_ptr<Acquisition> acquisition() const {
+        std::lock_guard<std::mutex> lock (acqMutex);
+        return acq;
+      }
+
+      /**
+         @brief Conversion coefficients of a channel.
+      */
+      struct Scaling {
+        double fsr; ///< fullScaleRange() of the channel
+        double range; ///< range() of the converter
+        long min; ///< min() in the mode of the entry
+        long max; ///< max() in the mode of the entry
+        bool valid; ///< false until loaded from the virtual functions
+        Scaling() : fsr (0), range (1), min (0), max (0), valid (false) {}
+      };
+
+      /**
+         @brief Returns the coefficients of a channel, they are read once from
+         the virtual functions and cached until invalidateScaling().
+
+         Returns a copy, the cache may be cleared by another thread.
+      */
+      Scaling scaling (int channel, bool differential) const;
+
+      /**
+         @brief Clears the cached coefficients, called by the public setters
+         of the reference, range, bipolar mode and channel modes.
+      */
+      void invalidateScaling() {
+        std::lock_guard<std::mutex> lock (scalingMutex);
+        scalingCache.clear();
+        scalingGeneration++;
+      }
+
       //-- Private data members ------------------------------------------------------
 
       /**
@@ -482,6 +718,30 @@ namespace Piduino {
       */
       std::vector<std::string> parameters; ///< Parameters for the converter, e.g., "param1:param2:param3"
 
+      /**
+         @brief Background acquisition, nullptr if never started.
+      */
+      std::shared_ptr<Acquisition> acq;
+      mutable std::mutex acqMutex; ///< Protects acq, never held while joining the thread
+      std::mutex acqControlMutex; ///< Serializes startAcquisition() and stopAcquisition()
+
+      /**
+         @brief Serializes the bus accesses of the read functions with the acquisition thread.
+      */
+      std::mutex ioMutex;
+
+      mutable std::vector<Scaling> scalingCache; ///< Coefficients by channel, single-ended and differential
+      mutable std::mutex scalingMutex; ///< Protects scalingCache and scalingGeneration
+      unsigned long scalingGeneration = 0; ///< Incremented by invalidateScaling()
+
+      std::mutex handlerMutex; ///< Protects streamHandler and streamUserData
+      StreamHandler streamHandler; ///< Handler called after each scan
+      void *streamUserData; ///< User data passed to streamHandler
+
+      double acqRate; ///< Scan rate given by the rate= option, 0 if none
+      int acqFirst; ///< First channel given by the scan= option
+      int acqLast; ///< Last channel given by the scan= option
+
       /**
          @brief Macro to declare the public interface for the Converter.
       */
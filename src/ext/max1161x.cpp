@@ -15,6 +15,7 @@
    along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
 */
 #include <iostream>
+#include <algorithm>
 #include <piduino/clock.h>
 #include "max1161x_p.h"
 #include "config.h"
@@ -153,7 +154,7 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   // Register the Max1161x converter with the factory
-  REGISTER_CONVERTER (Max1161x, "adc", "bus=id:max={12,13,14,15,16,17}:ref={ext,vdd,int1,int2,int3,int4}:fsr=value:bipolar={1,0}:clk={int,ext}");
+  REGISTER_CONVERTER (Max1161x, "adc", "bus=id:max={12,13,14,15,16,17}:ref={ext,vdd,int1,int2,int3,int4}:fsr=value:bipolar={1,0}:clk={int,ext}:rate=hz:scan=first-last");
 
   // -----------------------------------------------------------------------------
   //
@@ -370,31 +371,8 @@ namespace Piduino {
       if (sendByte (config (channel, differential))) {
 
         if (getLastConversion (result)) {
-          static const long MASK_12 = 0xFFF;         // 12-bit mask
-
-          // When operating in differential mode, the BIP/UNI bit of the set-up byte selects unipolar or bipolar
-          // operation. Unipolar mode sets the differential input range from 0 to VREF.
-          // A negative differential analog input in unipolar mode causes the digital output code to be zero.
-          // Selecting bipolar mode sets the differential input range to ±VREF/2.
-          // The digital output code is binary in unipolar mode and two’s complement in bipolar mode.
-          // IMPORTANT: In single-ended mode, the BIP/UNI bit is ignored:
-          // In single-ended mode, the MAX11612–MAX11617 always operates in unipolar mode irrespective of
-          // BIP/UNI. The analog inputs are internally referenced to
-          // GND with a full-scale input range from 0 to VREF.
-
-          if (bipolar && differential) {
-            // Portable sign extension for 12 bits to long
-            static const long SIGN_BIT_12 = 1L << 11;  // Bit 11 = sign bit for 12 bits
-
-            result &= MASK_12;                   // Clean first
-            if (result & SIGN_BIT_12) {          // If sign bit is set
-              result |= ~MASK_12;                // Portable sign extension
-            }
-          }
-          else {
-            // If in unipolar mode, we can return the result directly
-            result &= MASK_12; // Mask to ensure we only get the lower 12 bits
-          }
+
+          result = decode (result, differential);
           clearError(); // Clear any previous error
           isConnected = true; // Set the connection status to true
         }
@@ -412,6 +390,97 @@ namespace Piduino {
   }
 
 
+  // ---------------------------------------------------------------------------
+  // override
+  bool
+  Max1161x::Private::readChannels (int first, int last, long *values, bool differential) {
+
+    if (differential || last >= max.nchan || (last == (max.nchan - 1) && isRefPinUsed())) {
+      // the scan of the pairs and the AIN_/REF pin are not handled, the default
+      // implementation reads each channel and reports the invalid channels
+      return Converter::Private::readChannels (first, last, values, differential);
+    }
+
+    long buffer[12]; // MAX11616/MAX11617 have 12 channels, 24 bytes < I2C_BLOCK_MAX
+    if (readConversions (config (last, false, ScanToPin), buffer, last + 1, false)) {
+
+      std::copy (buffer + first, buffer + last + 1, values);
+      return true;
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  // override
+  bool
+  Max1161x::Private::readBlock (int channel, long *values, size_t count, bool differential) {
+
+    if (channel >= 0 && channel < max.nchan) {
+      // 2 bytes per conversion, a request is limited to I2C_BLOCK_MAX (32 bytes)
+      static const size_t ChunkSize = 16;
+      // With the internal clock, the conversion is started by the read address byte
+      // and the following bytes of the request repeat its result, so each sample
+      // needs its own request. With the external clock, each 2-byte result read
+      // by the master starts a new conversion of the selected input.
+      const size_t chunk = (clkSetting == ExternalClock) ? ChunkSize : 1;
+
+      // the scan is disabled, the config byte is sent once for the whole block
+      if (!sendByte (config (channel, differential))) {
+
+        return false;
+      }
+      for (size_t done = 0; done < count;) {
+        int n = static_cast<int> (std::min (chunk, count - done));
+
+        if (!receiveConversions (values + done, n, differential)) {
+
+          return false;
+        }
+        done += n;
+      }
+      return true;
+    }
+
+    setError (EINVAL);
+    if (isDebug) {
+      std::cerr << "Max1161x::Private::readBlock: Invalid channel " << channel << ". Valid range is 0 to " << (max.nchan - 1) << "." << std::endl;
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  // override
+  double
+  Max1161x::Private::readAverage (int channel, bool differential, int count) {
+
+    if (channel >= 0 && channel < max.nchan) {
+      static const int RepeatCount = 8; // conversions per burst in repeat mode
+      long burst[RepeatCount];
+      long long sum = 0;
+
+      for (int done = 0; done < count;) {
+        int n = std::min (RepeatCount, count - done);
+
+        // the last burst always converts 8 times, the extra samples are discarded
+        if (!readConversions (config (channel, differential, ScanRepeat), burst, RepeatCount, differential)) {
+
+          return InvalidValue;
+        }
+        for (int i = 0; i < n; i++) {
+          sum += burst[i];
+        }
+        done += n;
+      }
+      return static_cast<double> (sum) / count;
+    }
+
+    setError (EINVAL);
+    if (isDebug) {
+      std::cerr << "Max1161x::Private::readAverage: Invalid channel " << channel << ". Valid range is 0 to " << (max.nchan - 1) << "." << std::endl;
+    }
+    return InvalidValue;
+  }
+
   // ---------------------------------------------------------------------------
   // internal
   bool Max1161x::Private::sendByte (uint8_t data) {
@@ -470,6 +539,89 @@ namespace Piduino {
     return false; // Return false if reading the conversion fails
   }
 
+  // ---------------------------------------------------------------------------
+  // internal
+  // Sends the config byte and reads the count conversions in a single transaction:
+  // START + ADDR + W + CONFIG + RESTART + ADDR + R + count x 2 bytes + STOP
+  bool Max1161x::Private::readConversions (uint8_t config, long *values, int count, bool differential) {
+
+    i2c->beginTransmission (max.addr);
+    i2c->write (config);
+    if (i2c->endTransmission (false)) {
+
+      return receiveConversions (values, count, differential);
+    }
+
+    setError (i2c->error() ? i2c->error() : EIO);
+    if (isDebug) {
+      std::cerr << "Max1161x: Failed to send the configuration. Error(" << error << ") :" << errorString << std::endl;
+    }
+    isConnected = false; // Set the connection status to false
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  // internal
+  // Reads count conversions with the configuration already sent:
+  // START + ADDR + R + count x 2 bytes + STOP
+  bool Max1161x::Private::receiveConversions (long *values, int count, bool differential) {
+    int len = count * 2;
+
+    if (i2c->requestFrom (max.addr, len) == len) {
+
+      for (int i = 0; i < count; i++) {
+        int b1 = i2c->read();
+        int b2 = i2c->read();
+
+        values[i] = decode ( ( (b1 & 0x0F) << 8) | b2, differential);
+      }
+      clearError(); // Clear any previous error
+      isConnected = true; // Set the connection status to true
+      return true;
+    }
+
+    if (i2c->error()) {
+
+      setError (); // Get errno and set error message
+    }
+    else {
+
+      setError (EIO); // Set I/O error if no error code is available
+    }
+    if (isDebug) {
+      std::cerr << "Max1161x: Failed to read " << count << " conversions. Error(" << error << ") :" << errorString << std::endl;
+    }
+    isConnected = false; // Set the connection status to false
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  // internal
+  long Max1161x::Private::decode (long raw, bool differential) const {
+    static const long MASK_12 = 0xFFF;         // 12-bit mask
+
+    // When operating in differential mode, the BIP/UNI bit of the set-up byte selects unipolar or bipolar
+    // operation. Unipolar mode sets the differential input range from 0 to VREF.
+    // A negative differential analog input in unipolar mode causes the digital output code to be zero.
+    // Selecting bipolar mode sets the differential input range to ±VREF/2.
+    // The digital output code is binary in unipolar mode and two’s complement in bipolar mode.
+    // IMPORTANT: In single-ended mode, the BIP/UNI bit is ignored:
+    // In single-ended mode, the MAX11612–MAX11617 always operates in unipolar mode irrespective of
+    // BIP/UNI. The analog inputs are internally referenced to
+    // GND with a full-scale input range from 0 to VREF.
+
+    raw &= MASK_12; // Mask to ensure we only get the lower 12 bits
+    if (bipolar && differential) {
+      // Portable sign extension for 12 bits to long
+      static const long SIGN_BIT_12 = 1L << 11;  // Bit 11 = sign bit for 12 bits
+
+      if (raw & SIGN_BIT_12) {          // If sign bit is set
+        raw |= ~MASK_12;                // Portable sign extension
+      }
+    }
+    return raw;
+  }
+
   // ---------------------------------------------------------------------------
   // internal
   bool Max1161x::Private::updateSetup () {
@@ -75,6 +75,34 @@ namespace Piduino {
       */
       virtual long readChannel (int channel = 0, bool differential = false) override;
 
+      /**
+         @brief Reads a range of channels with the scan mode of the converter.
+
+         The channels AIN0 to \c last are converted and read in a single I2C transaction,
+         the values of the channels before \c first are discarded.
+         The differential mode and the AIN_/REF pin used as reference fall back to
+         the channel by channel implementation.
+      */
+      virtual bool readChannels (int first, int last, long *values, bool differential = false) override;
+
+      /**
+         @brief Reads a block of samples of a channel with the continuous read of the converter.
+
+         The config byte is sent once for the whole block. With the internal clock,
+         each sample is converted and read by its own 2-byte request. With the
+         external clock, each 2-byte result read by the master starts a new
+         conversion, the results are read by requests of 16 samples (I2C_BLOCK_MAX bytes).
+      */
+      virtual bool readBlock (int channel, long *values, size_t count, bool differential = false) override;
+
+      /**
+         @brief Reads the average of count samples with the repeat mode of the converter.
+
+         The selected input is converted 8 times and the results are read in a single
+         I2C transaction, counts above 8 are handled with several bursts.
+      */
+      virtual double readAverage (int channel, bool differential, int count) override;
+
       /**
         @brief Returns the number of channels supported by the converter.
         @return The number of channels, a channel is numbering from 0 to numberOfChannels() - 1.
@@ -203,6 +231,17 @@ namespace Piduino {
       // ------------------------- internal methods -------------------------
       bool sendByte (uint8_t data);
       bool getLastConversion (long &conversion);
+      bool readConversions (uint8_t config, long *values, int count, bool differential);
+      bool receiveConversions (long *values, int count, bool differential);
+      long decode (long raw, bool differential) const;
+
+      // true if the last analog input is used as reference input/output (AIN_/REF pin)
+      inline bool isRefPinUsed() const {
+        bool hasRefPin = (max.id == Max11612) || (max.id == Max11613) || (max.id == Max11616) || (max.id == Max11617);
+
+        return hasRefPin && (referenceId == ExternalReference || referenceId == InternalReference ||
+                             referenceId == Internal3Reference || referenceId == Internal4Reference);
+      }
       bool updateSetup ();
 
       // ----------------- internal typedef and structures ------------------
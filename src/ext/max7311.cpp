@@ -61,7 +61,118 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   // Register the Max7311 converter with the factory
-  REGISTER_CONVERTER (Max7311, "gpioexp", "bus=id:addr={0x20...0xDE}:bustimeout={0,1}");
+  REGISTER_CONVERTER (Max7311, "gpioexp", "bus=id:addr={0x20...0xDE}:bustimeout={0,1}:int=pin");
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::busTimeout() const {
+    PIMP_D (const Max7311);
+
+    return d->busTimeout;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::setBusTimeout (bool enable) {
+    PIMP_D (Max7311);
+
+    std::lock_guard<std::recursive_mutex> lock (d->mutex);
+
+    d->busTimeout = enable;
+    if (isOpen()) {
+
+      d->regs.set (TimeoutReg, enable ? 0x01 : 0x00);
+      return d->flush();
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::autoSync() const {
+    PIMP_D (const Max7311);
+
+    return d->autoSync;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::setAutoSync (bool enable) {
+    PIMP_D (Max7311);
+    std::lock_guard<std::recursive_mutex> lock (d->mutex);
+
+    d->autoSync = enable;
+    return enable && isOpen() ? d->flush() : true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::sync() {
+
+    if (isOpen()) {
+      PIMP_D (Max7311);
+
+      return d->flush();
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::update() {
+
+    if (isOpen()) {
+      PIMP_D (Max7311);
+
+      return d->updateInputs();
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Max7311::setInterruptPin (Pin *pin) {
+    PIMP_D (Max7311);
+
+    d->detachInterrupt();
+    d->intPin = pin;
+    if (isOpen() && pin) {
+
+      return d->attachInterrupt();
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  Pin *
+  Max7311::interruptPin() const {
+    PIMP_D (const Max7311);
+
+    return d->intPin;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Max7311::attachChangeHandler (ChangeHandler handler, int channel, void *userData) {
+    PIMP_D (Max7311);
+    std::lock_guard<std::recursive_mutex> lock (d->mutex);
+
+    for (int i = 0; i < static_cast<int> (d->handlers.size()); i++) {
+
+      if (channel < 0 || channel == i) {
+
+        d->handlers[i].func = handler;
+        d->handlers[i].userData = userData;
+      }
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Max7311::detachChangeHandler (int channel) {
+
+    attachChangeHandler (nullptr, channel, nullptr);
+  }
 
   // -----------------------------------------------------------------------------
   //
@@ -73,13 +184,27 @@ namespace Piduino {
   Max7311::Private::Private (Max7311 *q, std::shared_ptr<I2cDev> dev, int address) :
     Converter::Private (q, GpioExpander, hasResolution | hasRange | hasModeSetting | hasToggle),
     i2c (dev),
-    addr (address), isConnected (false), busTimeout (true) {}
+    addr (address), isConnected (false), busTimeout (true), autoSync (true),
+    regs ([this] (uint8_t reg, uint8_t *buf, uint16_t len) {
+            return readRegister (reg, buf, len);
+          },
+          [this] (uint8_t reg, const uint8_t *buf, uint16_t len) {
+            return writeRegister (reg, buf, len);
+          }),
+    intPin (nullptr), intAttached (false) {}
 
   // ---------------------------------------------------------------------------
   Max7311::Private::Private (Max7311 *q, const std::string &params) :
     Converter::Private (q, GpioExpander, hasResolution | hasRange | hasModeSetting | hasToggle, params),
     i2c (std::make_shared<I2cDev> (I2cDev::Info::defaultBus().id())),
-    addr (0x20), isConnected (false), busTimeout (true) {
+    addr (0x20), isConnected (false), busTimeout (true), autoSync (true),
+    regs ([this] (uint8_t reg, uint8_t *buf, uint16_t len) {
+            return readRegister (reg, buf, len);
+          },
+          [this] (uint8_t reg, const uint8_t *buf, uint16_t len) {
+            return writeRegister (reg, buf, len);
+          }),
+    intPin (nullptr), intAttached (false) {
 
     std::map<std::string, std::string> paramsMap = parseParameters (parameters);
 
@@ -102,6 +227,11 @@ namespace Piduino {
         busTimeout = false;
       }
     }
+
+    it = paramsMap.find ("int");
+    if (it != paramsMap.end()) {
+      intPin = getPin (it->second); // throw an exception if not found
+    }
   }
 
   // ---------------------------------------------------------------------------
@@ -114,17 +244,15 @@ namespace Piduino {
         std::cout << "Max7311: Device opened successfully." << std::endl;
       }
 
-      if (readAllRegisters ()) {
+      std::unique_lock<std::recursive_mutex> lock (mutex);
+      regs.invalidate(); // the device may have been modified while closed
+      if (regs.refresh ()) {
         if (isDebug) {
           std::cout << "Max7311: Setup updated successfully." << std::endl;
         }
-        // regs.config[0] = 0xFF; // Set all pins as inputs by default
-        // regs.config[1] = 0xFF; // Set all pins as inputs by default
-        // regs.polarity[0] = 0x00; //  Set all pins to normal polarity by default
-        // regs.polarity[1] = 0x00; // Set all pins to
-        regs.timeout = busTimeout ? 0x01 : 0x00; // Set timeout register based on busTimeout
+        regs.set (TimeoutReg, busTimeout ? 0x01 : 0x00); // Set timeout register based on busTimeout
 
-        if (writeSetup ()) { // Write the setup to the device
+        if (flush ()) { // Write the setup to the device, only if modified
           if (isDebug) {
             std::cout << "Max7311: Setup written successfully." << std::endl;
           }
@@ -136,6 +264,12 @@ namespace Piduino {
         }
 
         isConnected = true; // Set the connection status to true
+        lock.unlock();
+        if (intPin && !attachInterrupt()) {
+          if (isDebug) {
+            std::cerr << "Max7311: Failed to attach interrupt, inputs will be polled." << std::endl;
+          }
+        }
         return Converter::Private::open (mode);
       }
       else {
@@ -168,6 +302,7 @@ namespace Piduino {
   // override
   void
   Max7311::Private::close() {
+    detachInterrupt();
     Converter::Private::close();
   }
 
@@ -176,8 +311,11 @@ namespace Piduino {
   long
   Max7311::Private::read() {
     long value = InvalidValue;
-    if (readInputPorts()) {
-      value = (regs.input[1] << 8) | regs.input[0];
+    std::lock_guard<std::recursive_mutex> lock (mutex);
+
+    // inputs refreshed by the interrupt handler are served from memory
+    if (inputsCached() || updateInputs()) { // one burst for both input ports
+      value = inputs();
     }
     else {
       if (isDebug) {
@@ -194,9 +332,15 @@ namespace Piduino {
     long value = InvalidValue;
     uint8_t index = channel / 8; // Determine the index of the input port
 
-    if (readInputPorts (index, 1)) {
-      uint8_t bit = channel % 8; // Determine the bit position within the port
-      value = (regs.input[index] >> bit) & 0x01; // Read the specific bit
+    if (index <= 1) {
+      std::lock_guard<std::recursive_mutex> lock (mutex);
+
+      // the last burst read is used if the synchronization is manual (see update())
+      // or if the inputs are refreshed by the interrupt handler
+      if (inputsCached() || updateInputs()) {
+        uint8_t bit = channel % 8; // Determine the bit position within the port
+        value = (regs.value (InputPort1Reg + index) >> bit) & 0x01; // Read the specific bit
+      }
     }
     return value;
   }
@@ -204,9 +348,11 @@ namespace Piduino {
   // override
   bool
   Max7311::Private::write (long value) {
-    regs.output[1] = (value >> 8) & 0xFF; // Set the high byte
-    regs.output[0] = value & 0xFF; // Set the low byte
-    if (writeOutputPorts()) {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
+
+    regs.set (OutputPort2Reg, (value >> 8) & 0xFF); // Set the high byte
+    regs.set (OutputPort1Reg, value & 0xFF); // Set the low byte
+    if (commit()) {
       if (isDebug) {
         std::cout << "Max7311: Output ports written successfully." << std::endl;
       }
@@ -222,19 +368,21 @@ namespace Piduino {
   // override
   bool
   Max7311::Private::toggle (int channel) {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
 
     if (channel >= 0) {
       uint8_t index = channel / 8; // Determine the index of the output port
 
-      if (index >= 0 && index <= 1) {
+      if (index <= 1) {
 
-        if (readOutputPorts (index, 1)) { // Read the current output state
+        if (regs.fetch (OutputPort1Reg + index)) { // Output state is cached, read only if unknown
           uint8_t bit = channel % 8; // Determine the bit position within the port
+          uint8_t reg = OutputPort1Reg + index;
 
           // Toggle the specific bit
-          regs.output[index] ^= (1 << bit);
+          regs.set (reg, regs.value (reg) ^ (1 << bit));
 
-          if (writeOutputPorts (index, 1)) {
+          if (commit()) {
             if (isDebug) {
               std::cout << "Max7311: Output channel " << channel << " toggled successfully" << std::endl;
             }
@@ -254,12 +402,12 @@ namespace Piduino {
       }
     }
     else {
-      if (readOutputPorts ()) { // Read both output ports
+      if (regs.fetch (OutputPort1Reg, 2)) { // Output state is cached, read only if unknown
         // Toggle all bits in both output ports
-        regs.output[0] ^= 0xFF; // Toggle all bits in port 1
-        regs.output[1] ^= 0xFF; // Toggle all bits in port 2
+        regs.set (OutputPort1Reg, regs.value (OutputPort1Reg) ^ 0xFF); // Toggle all bits in port 1
+        regs.set (OutputPort2Reg, regs.value (OutputPort2Reg) ^ 0xFF); // Toggle all bits in port 2
 
-        if (writeOutputPorts ()) {
+        if (commit()) {
           if (isDebug) {
             std::cout << "Max7311: All output channels toggled successfully" << std::endl;
           }
@@ -278,19 +426,15 @@ namespace Piduino {
   bool
   Max7311::Private::writeChannel (long value, int channel, bool differential) {
     uint8_t index = channel / 8; // Determine the index of the input port
-    if (index >= 0 && index <= 1) {
-      uint8_t bit = channel % 8; // Determine the bit position within the port
-
-      if (value) {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
 
-        regs.output[index] |= (1 << bit); // Set the specific bit to 1
-      }
-      else {
+    if (index <= 1 && regs.fetch (OutputPort1Reg + index)) {
+      uint8_t bit = channel % 8; // Determine the bit position within the port
 
-        regs.output[index] &= ~ (1 << bit); // Set the specific bit to 0
-      }
+      // Set the specific bit to 1 or 0, the register is only written if it changes
+      regs.setBits (OutputPort1Reg + index, 1 << bit, value ? 0xFF : 0x00);
 
-      if (writeOutputPorts (index, 1)) {
+      if (commit()) {
         if (isDebug) {
           std::cout << "Max7311: Output channel " << channel << " written successfully" << std::endl;
         }
@@ -309,13 +453,15 @@ namespace Piduino {
   Max7311::Private::mode (int channel) const {
     Mode result = NoMode;
     uint8_t index = channel / 8; // Determine the index of the input port
+    std::lock_guard<std::recursive_mutex> lock (mutex);
 
-    if (index >= 0 && index <= 1) {
+    if (index <= 1) {
 
-      if (readSetup (index, 1)) { // Read the setup for the specific port
+      // Setup is cached, the device is only read if the cache is not loaded
+      if (regs.fetch (Polarity1Reg + index) && regs.fetch (Config1Reg + index)) {
         uint8_t bit = channel % 8; // Determine the bit position within the port
 
-        if ( (regs.config[index] & (1 << bit)) == 0) {
+        if ( (regs.value (Config1Reg + index) & (1 << bit)) == 0) {
 
           result |= DigitalOutput; // If the bit is 0, it's an output mode
         }
@@ -324,7 +470,7 @@ namespace Piduino {
           result |= DigitalInput | PullUp; // If the bit is 1, it's an input mode
         }
 
-        if ( (regs.polarity[index] & (1 << bit)) != 0) {
+        if ( (regs.value (Polarity1Reg + index) & (1 << bit)) != 0) {
 
           result |= ActiveLow; // If the bit is set, it's active low
         }
@@ -343,6 +489,7 @@ namespace Piduino {
   // override
   bool
   Max7311::Private::setMode (Mode m, int channel) {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
 
     if (m & ~ (DigitalOutput | DigitalInput | ActiveLow)) {
 
@@ -363,66 +510,60 @@ namespace Piduino {
     if (channel >= 0) {
       uint8_t index = channel / 8; // Determine the index of the input port
 
-      if (index >= 0 && index <= 1) {
-        if (readSetup (index, 1)) { // Read the setup for the specific port
+      if (index <= 1) {
+        if (regs.fetch (Polarity1Reg + index) && regs.fetch (Config1Reg + index)) {
 
-          uint8_t bit = channel % 8; // Determine the bit position within the port
+          uint8_t mask = 1 << channel % 8; // Determine the bit position within the port
 
           if (m & DigitalOutput) {
 
-            regs.config[index] &= ~ (1 << bit); // Set the specific bit to 0 for output
+            regs.setBits (Config1Reg + index, mask, 0x00); // Set the specific bit to 0 for output
           }
           else if (m & DigitalInput) {
 
-            regs.config[index] |= (1 << bit); // Set the specific bit to 1 for input
-          }
-          if (m & ActiveLow) {
-
-            regs.polarity[index] |= (1 << bit); // Set the specific bit to 1 for active low
+            regs.setBits (Config1Reg + index, mask, 0xFF); // Set the specific bit to 1 for input
           }
-          else {
+          // Set the specific bit to 1 for active low, 0 for normal polarity
+          regs.setBits (Polarity1Reg + index, mask, (m & ActiveLow) ? 0xFF : 0x00);
 
-            regs.polarity[index] &= ~ (1 << bit); // Set the specific bit to 0 for normal polarity
-          }
-
-          return writeSetup (index, 1); // Write the setup for the specific port
+          return commit(); // Write the modified registers only
         }
         if (isDebug) {
-          std::cerr << "Max7311: Invalid channel " << channel << std::endl;
+          std::cerr << "Max7311: Failed to read setup for channel " << channel << std::endl;
         }
-        return false; // Return false if the channel index is invalid
+        return false; // Return false if reading setup fails
       }
       else {
         if (isDebug) {
-          std::cerr << "Max7311: Failed to read setup for channel " << channel << std::endl;
+          std::cerr << "Max7311: Invalid channel " << channel << std::endl;
         }
-        return false; // Return false if reading setup fails
+        return false; // Return false if the channel index is invalid
       }
     }
     else { // set all channels
 
       if (m & DigitalOutput) {
 
-        regs.config[0] = 0x00; // Set all pins as outputs
-        regs.config[1] = 0x00; // Set all pins as outputs
+        regs.set (Config1Reg, 0x00); // Set all pins as outputs
+        regs.set (Config2Reg, 0x00); // Set all pins as outputs
       }
       else  if (m & DigitalInput) {
 
-        regs.config[0] = 0xFF; // Set all pins as inputs
-        regs.config[1] = 0xFF; // Set all pins as inputs
+        regs.set (Config1Reg, 0xFF); // Set all pins as inputs
+        regs.set (Config2Reg, 0xFF); // Set all pins as inputs
       }
       if (m & ActiveLow) {
 
-        regs.polarity[0] = 0xFF; // Set all pins to active low
-        regs.polarity[1] = 0xFF; // Set all pins to active low
+        regs.set (Polarity1Reg, 0xFF); // Set all pins to active low
+        regs.set (Polarity2Reg, 0xFF); // Set all pins to active low
       }
       else {
 
-        regs.polarity[0] = 0x00; // Set all pins to normal polarity
-        regs.polarity[1] = 0x00; // Set all pins to normal polarity
+        regs.set (Polarity1Reg, 0x00); // Set all pins to normal polarity
+        regs.set (Polarity2Reg, 0x00); // Set all pins to normal polarity
       }
 
-      return writeSetup (); // Write the setup to the device
+      return commit(); // Write the setup to the device
     }
     return false;
   }
@@ -431,6 +572,7 @@ namespace Piduino {
   // internal
   int
   Max7311::Private::readRegister (uint8_t reg, uint8_t *buffer, uint16_t max) const {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
 
     if (i2c->isOpen() && reg <= TimeoutReg) {
       // Implement I2C read operation here
@@ -471,6 +613,7 @@ namespace Piduino {
   // ---------------------------------------------------------------------------
   // internal
   int Max7311::Private::writeRegister (uint8_t reg, const uint8_t *data, uint16_t size) {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
 
     if (i2c->isOpen()) {
 
@@ -489,93 +632,84 @@ namespace Piduino {
   // ---------------------------------------------------------------------------
   // internal
   bool
-  Max7311::Private::readInputPorts (uint8_t index, uint8_t nb) const {
-
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
+  Max7311::Private::attachInterrupt() {
+
+    if (intPin && !intAttached) {
+
+      try {
+        // INT is an open drain output, active low, released when the inputs are read
+        intPin->setMode (Pin::ModeInput);
+        intPin->setPull (Pin::PullUp);
+        intPin->attachInterrupt (isr, Pin::EdgeFalling, this);
+        intAttached = true;
+        // loads the shadow registers and releases INT
+        std::lock_guard<std::recursive_mutex> lock (mutex);
+        updateInputs();
+      }
+      catch (std::exception &e) {
 
-      return readRegister (InputPort1Reg  + index, &regs.input[index], nb) == nb;
+        if (isDebug) {
+          std::cerr << "Max7311: " << e.what() << std::endl;
+        }
+        intAttached = false;
+      }
     }
-    return false;
+    return intAttached;
   }
 
-  // ----------------------------------------------------------------------
+  // ---------------------------------------------------------------------------
   // internal
-  bool
-  Max7311::Private::readOutputPorts (uint8_t index, uint8_t nb) const {
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
-
-      return readRegister (OutputPort1Reg + index, &regs.output[index], nb) == nb;
-    }
-    return false;
-  }
+  void
+  Max7311::Private::detachInterrupt() {
 
-  // ----------------------------------------------------------------------
-  // internal
-  bool
-  Max7311::Private::writeOutputPorts (uint8_t index, uint8_t nb) {
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
+    if (intAttached) {
 
-      return writeRegister (OutputPort1Reg + index, &regs.output[index], nb) == nb;
+      intPin->detachInterrupt();
+      intAttached = false;
     }
-    return false;
   }
 
-  // ----------------------------------------------------------------------
+  // ---------------------------------------------------------------------------
   // internal
-  bool Max7311::Private::readPolarityInversion (uint8_t index, uint8_t nb) const {
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
-
-      return readRegister (Polarity1Reg + index, &regs.polarity[index], nb) == nb;
-    }
-    return false;
-  }
+  void
+  Max7311::Private::handleInterrupt() {
+    uint16_t before, after, changed;
+    std::array<Handler, 16> h;
 
-  // ----------------------------------------------------------------------
-  // internal
-  bool
-  Max7311::Private::writePolarityInversion (uint8_t index, uint8_t nb) {
+    {
+      std::lock_guard<std::recursive_mutex> lock (mutex);
+      bool valid = regs.isValid (InputPort1Reg) && regs.isValid (InputPort2Reg);
 
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
+      before = inputs();
+      if (!updateInputs()) { // single burst for both ports, releases INT
 
-      return writeRegister (Polarity1Reg + index, &regs.polarity[index], nb) == nb;
+        if (isDebug) {
+          std::cerr << "Max7311: Failed to read input ports on interrupt." << std::endl;
+        }
+        return;
+      }
+      after = inputs();
+      changed = valid ? before ^ after : 0;
+      h = handlers; // may be modified by attachChangeHandler()
     }
-    return false;
-  }
 
-  // ----------------------------------------------------------------------
-  // internal
-  bool
-  Max7311::Private::readConfiguration (uint8_t index, uint8_t nb) const {
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
+    // handlers are called without lock, they may access the device
+    for (int channel = 0; changed; channel++, changed >>= 1) {
 
-      return readRegister (Config1Reg + index, &regs.config[index], nb) == nb;
-    }
-    return false;
-  }
+      if ( (changed & 1) && h[channel].func) {
 
-  // ----------------------------------------------------------------------
-  // internal
-  bool
-  Max7311::Private::writeConfiguration (uint8_t index, uint8_t nb) {
-    if (index >= 0 && index <= 1 && nb > 0 && (index + nb) <= 2) {
-
-      return writeRegister (Config1Reg + index, &regs.config[index], nb) == nb;
+        h[channel].func (channel, (after >> channel) & 1, h[channel].userData);
+      }
     }
-    return false;
   }
 
-  // ----------------------------------------------------------------------
-  // internal
-  bool
-  Max7311::Private::readTimeout () const {
-    return readRegister (TimeoutReg, &regs.timeout, 1) == 1;
-  }
+  // ---------------------------------------------------------------------------
+  // static
+  void
+  Max7311::Private::isr (Pin::Event event, void *userData) {
+    Max7311::Private *d = reinterpret_cast<Max7311::Private *> (userData);
 
-  // ----------------------------------------------------------------------
-  // internal
-  bool
-  Max7311::Private::writeTimeout () {
-    return writeRegister (TimeoutReg, &regs.timeout, 1) == 1;
+    d->handleInterrupt();
   }
 
 } // namespace Piduino
@@ -17,6 +17,10 @@
 #pragma once
 
 #include <piduino/max7311.h>
+#include <array>
+#include <mutex>
+#include <piduino/registermap.h>
+#include <piduino/gpiopin.h>
 #include "converter_p.h"
 
 namespace Piduino {
@@ -226,50 +230,74 @@ namespace Piduino {
       */
       int writeRegister (uint8_t reg, const uint8_t *data, uint16_t size);
 
-      // ---------------------------------------- I/O methods ---------------------------------------
-      bool readInputPorts (uint8_t index = 0, uint8_t nb = 2) const;
-      bool readOutputPorts (uint8_t index = 0, uint8_t nb = 2) const;
-      bool writeOutputPorts (uint8_t index = 0, uint8_t nb = 2);
-      bool readPolarityInversion (uint8_t index = 0, uint8_t nb = 2) const;
-      bool writePolarityInversion (uint8_t index = 0, uint8_t nb = 2);
-      bool readConfiguration (uint8_t index = 0, uint8_t nb = 2) const;
-      bool writeConfiguration (uint8_t index = 0, uint8_t nb = 2);
-      bool readTimeout () const;
-      bool writeTimeout ();
-
-      // ----------------------------------------------------------------------
-      // internal
-      inline bool readAllRegisters () const {
-        return readInputPorts() &&
-               readOutputPorts() &&
-               readPolarityInversion() &&
-               readConfiguration() &&
-               readTimeout();
+      /**
+         @brief Writes the modified registers to the device.
+         @return true on success, false otherwise.
+      */
+      inline bool flush() {
+        std::lock_guard<std::recursive_mutex> lock (mutex);
+        return regs.flush();
+      }
+
+      /**
+         @brief Writes the modified registers if automatic synchronization is enabled.
+         @return true on success or if the modifications are deferred, false otherwise.
+      */
+      inline bool commit() {
+        std::lock_guard<std::recursive_mutex> lock (mutex);
+        return !autoSync || regs.flush();
       }
 
-      // ----------------------------------------------------------------------
-      // internal
-      inline bool writeAllRegisters () {
-        return writeOutputPorts() &&
-               writePolarityInversion() &&
-               writeConfiguration() &&
-               writeTimeout();
+      /**
+         @brief Reads both input ports in a single burst.
+         @return true on success, false otherwise.
+      */
+      inline bool updateInputs() const {
+        std::lock_guard<std::recursive_mutex> lock (mutex);
+        return regs.refresh (0, 2);
       }
 
-      // ----------------------------------------------------------------------
-      // internal
-      inline bool writeSetup (uint8_t index = 0, uint8_t nb = 2) {
-        return  writePolarityInversion (index, nb) &&
-                writeConfiguration (index, nb);
+      /**
+         @brief Returns true if the input state can be read from the shadow registers.
+
+         This is the case when the inputs are refreshed by the interrupt handler or
+         when the synchronization is manual, once the input ports have been read.
+      */
+      inline bool inputsCached() const {
+        return (intAttached || !autoSync) && regs.isValid (0) && regs.isValid (1);
       }
 
-      // ----------------------------------------------------------------------
-      // internal
-      inline bool readSetup (uint8_t index = 0, uint8_t nb = 2) const {
-        return  readPolarityInversion (index, nb) &&
-                readConfiguration (index, nb);
+      /**
+         @brief Returns the input state stored in the shadow registers.
+      */
+      inline uint16_t inputs() const {
+        return (regs.value (1) << 8) | regs.value (0);
       }
 
+      /**
+         @brief Attaches the interrupt handler to intPin.
+         @return true on success, false otherwise.
+      */
+      bool attachInterrupt();
+
+      /**
+         @brief Detaches the interrupt handler from intPin.
+      */
+      void detachInterrupt();
+
+      /**
+         @brief Reads the input ports and calls the change handlers.
+         @note Called from the GPIO event thread.
+      */
+      void handleInterrupt();
+
+      /**
+         @brief Interrupt service routine attached to intPin.
+         @param event The GPIO event.
+         @param userData Pointer to the Private object.
+      */
+      static void isr (Pin::Event event, void *userData);
+
       // --------------------------- data members ---------------------------
       static constexpr uint8_t NofRegisters = 9; // Total number of registers
 
@@ -293,16 +321,55 @@ namespace Piduino {
       */
       bool busTimeout;
 
-      struct RegBuffers {
-        uint8_t input[2]; ///< Input register buffer
-        uint8_t output[2]; ///< Output register buffer
-        uint8_t polarity[2]; ///< Polarity inversion register buffer
-        uint8_t config[2]; ///< Configuration register buffer
-        uint8_t timeout; ///< Timeout register buffer
-        RegBuffers() : input{0}, output{0}, polarity{0}, config{0}, timeout (0) {}
+      /**
+         @brief Indicates if the modifications are written immediately (see Max7311::setAutoSync()).
+      */
+      bool autoSync;
+
+      /**
+         @brief Register layout of the MAX7311 for RegisterMap.
+
+         The device auto-increments inside a pair of registers (port 1, port 2),
+         the input ports are volatile, the others only change when written by the host.
+      */
+      struct Layout {
+        enum { Size = NofRegisters, BurstGroup = 2 };
+        static RegisterPolicy policy (uint8_t reg) {
+          return reg < 2 ? RegisterVolatile : RegisterCached;
+        }
       };
 
-      mutable RegBuffers regs; ///< Buffer for register values
+      mutable RegisterMap<Layout> regs; ///< Cached image of the registers
+
+      /**
+         @brief Pin connected to the INT output, nullptr if none.
+      */
+      Pin *intPin;
+
+      /**
+         @brief Indicates if the interrupt handler is attached to intPin.
+      */
+      bool intAttached;
+
+      /**
+         @brief Input change handler and its user data.
+      */
+      struct Handler {
+        ChangeHandler func;
+        void *userData;
+        Handler() : func (nullptr), userData (nullptr) {}
+      };
+
+      /**
+         @brief Input change handlers, one per channel.
+      */
+      std::array<Handler, 16> handlers;
+
+      /**
+         @brief Serializes the accesses to the device and the shadow registers,
+         the interrupt handler runs in the GPIO event thread.
+      */
+      mutable std::recursive_mutex mutex;
 
       PIMP_DECLARE_PUBLIC (Max7311)
   };
@@ -0,0 +1,398 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include "max7311gpio_p.h"
+#include "config.h"
+
+namespace Piduino {
+
+  // ---------------------------------------------------------------------------
+  const int Max7311Gpio::NumberOfLines;
+
+  // -----------------------------------------------------------------------------
+  //
+  //                         Max7311Gpio::Private Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Max7311Gpio::Private::Private (Max7311Gpio *q, Max7311 *expander, bool owner) :
+    GpioDevice::Private (q), exp (expander), owner (owner), batch (false) {}
+
+  // ---------------------------------------------------------------------------
+  Max7311Gpio::Private::~Private() {
+
+    if (owner) {
+      delete exp;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  int
+  Max7311Gpio::Private::checkLine (int line) {
+
+    if (line < 0 || line >= NumberOfLines) {
+
+      throw std::out_of_range (EXCEPTION_MSG ("Invalid MAX7311 line number " + std::to_string (line)));
+    }
+    return line;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Max7311Gpio::Private::throwError (const char *msg) const {
+    int err = exp->error() ? exp->error() : EIO;
+
+    throw std::system_error (err, std::system_category(), EXCEPTION_MSG (msg));
+  }
+
+  // ---------------------------------------------------------------------------
+  const std::map<Pin::Mode, std::string> Max7311Gpio::Private::modes = {
+    {Pin::ModeInput, "in"},
+    {Pin::ModeOutput, "out"},
+  };
+
+  // -----------------------------------------------------------------------------
+  //
+  //                             Max7311Gpio Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Max7311Gpio::Max7311Gpio (Max7311Gpio::Private &dd) : GpioDevice (dd) {}
+
+  // ---------------------------------------------------------------------------
+  Max7311Gpio::Max7311Gpio (int busId, int address) :
+    GpioDevice (*new Private (this, new Max7311 (busId, address), true)) {}
+
+  // ---------------------------------------------------------------------------
+  Max7311Gpio::Max7311Gpio (Max7311 *expander) :
+    GpioDevice (*new Private (this, expander, false)) {}
+
+  // ---------------------------------------------------------------------------
+  Max7311Gpio::~Max7311Gpio() {
+
+    close();
+  }
+
+  // -------------------------------------------------------------------------
+  unsigned int
+  Max7311Gpio::flags() const {
+    return hasToggle | hasPullRead | hasActiveLow;
+  }
+
+  // -------------------------------------------------------------------------
+  AccessLayer
+  Max7311Gpio::preferedAccessLayer() const {
+    // the lines are only reachable through the I2C character device
+    return AccessLayerGpioDev;
+  }
+
+  // -------------------------------------------------------------------------
+  bool
+  Max7311Gpio::open() {
+
+    if (!isOpen()) {
+      PIMP_D (Max7311Gpio);
+
+      if (d->exp->isOpen() || d->exp->open (IoDevice::ReadWrite)) {
+
+        d->isopen = true;
+      }
+      else if (isDebug()) {
+
+        std::cerr << "Max7311Gpio: Failed to open the expander: " << d->exp->errorString() << std::endl;
+      }
+    }
+    return isOpen();
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::close() {
+
+    if (isOpen()) {
+      PIMP_D (Max7311Gpio);
+
+      if (d->batch) {
+
+        d->batch = false;
+        d->exp->setAutoSync (true); // send the pending modifications
+      }
+      if (d->owner) {
+
+        d->exp->close();
+      }
+      d->isopen = false;
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  const std::map<Pin::Mode, std::string> &
+  Max7311Gpio::modes() const {
+
+    return Private::modes;
+  }
+
+  // -------------------------------------------------------------------------
+  Pin::Mode
+  Max7311Gpio::mode (int line) const {
+    PIMP_D (const Max7311Gpio);
+    Converter::Mode m = d->exp->mode (Private::checkLine (line));
+
+    if (m & Converter::DigitalOutput) {
+
+      return Pin::ModeOutput;
+    }
+    if (m & Converter::DigitalInput) {
+
+      return Pin::ModeInput;
+    }
+    return Pin::ModeUnknown;
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::setMode (int line, Pin::Mode m) {
+    PIMP_D (Max7311Gpio);
+    Converter::Mode cm;
+
+    switch (m) {
+      case Pin::ModeInput:
+        cm = Converter::DigitalInput;
+        break;
+      case Pin::ModeOutput:
+        cm = Converter::DigitalOutput;
+        break;
+      default:
+        throw std::invalid_argument (EXCEPTION_MSG ("MAX7311 lines only support ModeInput and ModeOutput"));
+    }
+    // keep the polarity inversion, the setup is cached by the expander
+    cm |= d->exp->mode (Private::checkLine (line)) & Converter::ActiveLow;
+
+    if (!d->exp->setMode (cm, line)) {
+
+      d->throwError ("Failed to set the mode of the MAX7311 line");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::write (int line, bool v) {
+    PIMP_D (Max7311Gpio);
+
+    if (!d->exp->writeChannel (v ? 1 : 0, Private::checkLine (line))) {
+
+      d->throwError ("Failed to write the MAX7311 line");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  bool
+  Max7311Gpio::read (int line) const {
+    PIMP_D (const Max7311Gpio);
+    long v = d->exp->readChannel (Private::checkLine (line));
+
+    if (v == Converter::InvalidValue) {
+
+      d->throwError ("Failed to read the MAX7311 line");
+    }
+    return v != 0;
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::toggle (int line) {
+    PIMP_D (Max7311Gpio);
+
+    if (!d->exp->toggle (Private::checkLine (line))) {
+
+      d->throwError ("Failed to toggle the MAX7311 line");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::writeAll (uint16_t values) {
+    PIMP_D (Max7311Gpio);
+
+    if (!d->exp->write (values)) {
+
+      d->throwError ("Failed to write the MAX7311 output ports");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  uint16_t
+  Max7311Gpio::readAll() const {
+    PIMP_D (const Max7311Gpio);
+    long v = d->exp->read();
+
+    if (v == Converter::InvalidValue) {
+
+      d->throwError ("Failed to read the MAX7311 input ports");
+    }
+    return static_cast<uint16_t> (v);
+  }
+
+  // -------------------------------------------------------------------------
+  Pin::Mode
+  Max7311Gpio::mode (const Pin *pin) const {
+
+    return mode (pin->mcuNumber());
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::setMode (const Pin *pin, Pin::Mode m) {
+
+    setMode (pin->mcuNumber(), m);
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::write (const Pin *pin, bool v) {
+
+    write (pin->mcuNumber(), v);
+  }
+
+  // -------------------------------------------------------------------------
+  bool
+  Max7311Gpio::read (const Pin *pin) const {
+
+    return read (pin->mcuNumber());
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::toggle (const Pin *pin) {
+
+    toggle (pin->mcuNumber());
+  }
+
+  // -------------------------------------------------------------------------
+  Pin::Pull
+  Max7311Gpio::pull (const Pin *pin) const {
+
+    // the inputs of the MAX7311 are always pulled up
+    return mode (pin) == Pin::ModeInput ? Pin::PullUp : Pin::PullOff;
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::setPull (const Pin * /*pin*/, Pin::Pull p) {
+
+    if (p != Pin::PullUp && p != Pin::PullUnknown) {
+
+      throw std::invalid_argument (EXCEPTION_MSG ("MAX7311 inputs are always pulled up"));
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  bool
+  Max7311Gpio::isActiveLow (const Pin *pin) const {
+    PIMP_D (const Max7311Gpio);
+
+    return (d->exp->mode (Private::checkLine (pin->mcuNumber())) & Converter::ActiveLow) ? true : false;
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::setActiveLow (const Pin *pin, bool activeLow) {
+    PIMP_D (Max7311Gpio);
+    int line = Private::checkLine (pin->mcuNumber());
+    Converter::Mode m = d->exp->mode (line) & (Converter::DigitalInput | Converter::DigitalOutput);
+
+    if (activeLow) {
+
+      m |= Converter::ActiveLow;
+    }
+    if (!d->exp->setMode (m, line)) {
+
+      d->throwError ("Failed to set the polarity of the MAX7311 line");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::beginBatch() {
+    PIMP_D (Max7311Gpio);
+
+    if (!d->batch) {
+
+      d->exp->setAutoSync (false);
+      d->batch = true;
+      update();
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::endBatch() {
+    PIMP_D (Max7311Gpio);
+
+    if (d->batch) {
+
+      d->batch = false;
+      if (!d->exp->setAutoSync (true)) {
+
+        d->throwError ("Failed to write the MAX7311 registers");
+      }
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  bool
+  Max7311Gpio::isBatch() const {
+    PIMP_D (const Max7311Gpio);
+
+    return d->batch;
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::sync() {
+    PIMP_D (Max7311Gpio);
+
+    if (!d->exp->sync()) {
+
+      d->throwError ("Failed to write the MAX7311 registers");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  void
+  Max7311Gpio::update() {
+    PIMP_D (Max7311Gpio);
+
+    if (!d->exp->update()) {
+
+      d->throwError ("Failed to read the MAX7311 input ports");
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  Max7311 *
+  Max7311Gpio::expander() const {
+    PIMP_D (const Max7311Gpio);
+
+    return d->exp;
+  }
+}
+/* ========================================================================== */
@@ -0,0 +1,45 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <piduino/max7311gpio.h>
+#include "../gpio/gpiodevice_p.h"
+
+namespace Piduino {
+
+  class Max7311Gpio::Private  : public GpioDevice::Private {
+
+    public:
+      Private (Max7311Gpio *q, Max7311 *expander, bool owner);
+      virtual ~Private();
+
+      // check the line number, throws std::out_of_range
+      static int checkLine (int line);
+
+      // throws std::system_error with the error of the expander
+      void throwError (const char *msg) const;
+
+      Max7311 *exp;
+      bool owner;
+      bool batch;
+
+      static const std::map<Pin::Mode, std::string> modes;
+
+      PIMP_DECLARE_PUBLIC (Max7311Gpio)
+  };
+}
+/* ========================================================================== */
@@ -15,6 +15,7 @@
    along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
 */
 #include <iostream>
+#include <algorithm>
 #include "mcp4725_p.h"
 #include "config.h"
 
@@ -265,6 +266,67 @@ namespace Piduino {
     return false;
   }
 
+  // ---------------------------------------------------------------------------
+  // override
+  // START + ADDR + W + (C2=0 C1=0 PD1 PD0 D11..D8, D7..D0) x n + STOP
+  bool
+  Mcp4725::Private::writeBlock (int channel, const long *values, size_t count, unsigned long period) {
+
+    if (period > 0 || (currentMode & SaveToEEPROM)) {
+
+      return Converter::Private::writeBlock (channel, values, count, period);
+    }
+
+    if (i2c->isOpen()) {
+      static const size_t ChunkSize = 16; // 2 bytes per sample, I2C_BLOCK_MAX bytes per request
+      uint8_t frame[ChunkSize * RegFastWriteLength];
+      uint8_t pd = 0;
+      long v = value;
+
+      // the power-down mode set by the user is kept in each frame
+      if (currentMode & PwrDwnEn) {
+        switch (currentMode.value() & PwrDwnMask) {
+          case PwrDwnR1:
+            pd = PD_FAST_1K;
+            break;
+          case PwrDwnR2:
+            pd = PD_FAST_100K;
+            break;
+          case PwrDwnR3:
+            pd = PD_FAST_500K;
+            break;
+          default:
+            break;
+        }
+      }
+
+      for (size_t done = 0; done < count;) {
+        size_t n = std::min (ChunkSize, count - done);
+
+        for (size_t i = 0; i < n; i++) {
+
+          v = clampValue (values[done + i]);
+          frame[2 * i] = pd | ( (v >> 8) & 0x0F); // fast mode
+          frame[2 * i + 1] = v & 0xFF;
+        }
+        i2c->beginTransmission (addr);
+        i2c->write (frame, n * RegFastWriteLength);
+        if (!i2c->endTransmission()) {
+
+          if (isDebug) {
+            std::cerr << "Mcp4725: Failed to write the block of samples." << std::endl;
+          }
+          return false;
+        }
+        this->value = v; // Update the current value
+        done += n;
+      }
+      isConnected = true;
+      return true;
+    }
+    return false;
+  }
+
   // ---------------------------------------------------------------------------
   // override
   Mcp4725::Mode
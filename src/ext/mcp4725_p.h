@@ -115,6 +115,16 @@ namespace Piduino {
       */
       virtual bool writeChannel (long value, int channel = 0, bool differential = false) override;
 
+      /**
+         @brief Writes a block of samples with chained fast write frames.
+
+         When period is 0, the 2-byte fast write commands of up to 16 samples are
+         sent after a single address byte, the DAC output is updated at the end of
+         each command. Otherwise, and in SaveToEEPROM mode, the default implementation
+         is used.
+      */
+      virtual bool writeBlock (int channel, const long *values, size_t count, unsigned long period) override;
+
 
       /**
          @brief Returns the current mode of the converter.
@@ -90,6 +90,27 @@ namespace Piduino {
     return d->fastWrite (values);
   }
 
+  // ---------------------------------------------------------------------------
+  bool
+  Mcp4728::setLdacPin (Pin *pin) {
+    PIMP_D (Mcp4728);
+
+    d->ldac = pin;
+    if (isOpen() && pin) {
+
+      return d->setupLdac();
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  Pin *
+  Mcp4728::ldacPin() const {
+    PIMP_D (const Mcp4728);
+
+    return d->ldac;
+  }
+
   // ---------------------------------------------------------------------------
   Mcp4728::Mcp4728 (int busId, int address) :
     Converter (*new Private (this, std::make_shared<I2cDev> (busId), address)) {}
@@ -103,7 +124,7 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   // Register the Mcp4728 converter with the factory
-  REGISTER_CONVERTER (Mcp4728, "dac", "bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}");
+  REGISTER_CONVERTER (Mcp4728, "dac", "bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}:ldac=pin");
 
   // -----------------------------------------------------------------------------
   //
@@ -115,14 +136,14 @@ namespace Piduino {
   Mcp4728::Private::Private (Mcp4728 *q, std::shared_ptr<I2cDev> dev, int address) :
     Converter::Private (q, DigitalToAnalog, hasResolution | hasRange | hasModeSetting | hasReference | hasSetReference | hasReferencePerChannel),
     i2c (dev),
-    addr (address), isConnected (false) {}
+    addr (address), isConnected (false), ldac (nullptr) {}
 
   // ---------------------------------------------------------------------------
-  // "bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}"
+  // "bus=id:addr={0x60..0x67}:ref={vdd,int}:fsr=value:gain={1,2}:mode={norm,fast,eeprom,pd1k,pd100k,pd500k}:ldac=pin"
   Mcp4728::Private::Private (Mcp4728 *q, const std::string &params) :
     Converter::Private (q, DigitalToAnalog, hasResolution | hasRange | hasModeSetting | hasReference | hasSetReference | hasReferencePerChannel, params),
     i2c (std::make_shared<I2cDev> (I2cDev::Info::defaultBus().id())),
-    addr (DefaultAddress), isConnected (false) {
+    addr (DefaultAddress), isConnected (false), ldac (nullptr) {
     int refId = DefaultReference;
     double fsr = 0.0;
     Mode m = DefaultMode; // AnalogOutput, Gain1
@@ -207,6 +228,11 @@ namespace Piduino {
       }
     }
 
+    it = paramsMap.find ("ldac");
+    if (it != paramsMap.end()) {
+      ldac = getPin (it->second); // throw an exception if not found
+    }
+
     for (auto &ch : chan) {
 
       ch.mode = m;
@@ -234,6 +260,10 @@ namespace Piduino {
 
           std::cout << "Mcp4728: Configuration updated successfully." << std::endl;
         }
+        if (ldac && !setupLdac()) {
+
+          return false;
+        }
         return Converter::Private::open (mode);
       }
     }
@@ -362,6 +392,45 @@ namespace Piduino {
     return false;
   }
 
+  // ---------------------------------------------------------------------------
+  // override
+  bool
+  Mcp4728::Private::writeChannels (const long *values, unsigned long mask) {
+    uint16_t frame[NofChannels];
+
+    for (int i = 0; i < NofChannels; ++i) {
+
+      if ( (mask & BIT (i)) && (chan[i].mode & SaveToEEPROM)) {
+        // the fast write command does not program the EEPROM
+        return Converter::Private::writeChannels (values, mask);
+      }
+      frame[i] = (mask & BIT (i)) ? static_cast<uint16_t> (clampValue (values[i])) : chan[i].value;
+    }
+
+    if (ldac) {
+      // the input registers are loaded without updating the outputs
+      ldac->write (true);
+    }
+    bool success = fastWrite (frame);
+    if (ldac) {
+      // all the outputs are updated on the falling edge
+      ldac->write (false);
+    }
+
+    if (success) {
+
+      for (int i = 0; i < NofChannels; ++i) {
+
+        chan[i].value = frame[i];
+      }
+    }
+    else if (isDebug) {
+
+      std::cerr << "Mcp4728: Fast write failed for channels mask: 0x" << std::hex << mask << std::dec << std::endl;
+    }
+    return success;
+  }
+
   // ---------------------------------------------------------------------------
   // override
   bool
@@ -497,8 +566,8 @@ namespace Piduino {
     uint8_t buffer[RegFastWriteLength];
 
     for (int i = 0; i < NofChannels; ++i) {
-
-      buffer[i * 2] = static_cast<uint8_t> ( (values[i] >> 8) & 0x0F); // High byte
+      // C2 C1 PD1 PD0 D11 D10 D9 D8, the power down bits are one position lower than in data[0]
+      buffer[i * 2] = static_cast<uint8_t> ( (values[i] >> 8) & 0x0F) | (powerDownBits (chan[i].mode) >> 1); // High byte
       buffer[i * 2 + 1] = static_cast<uint8_t> (values[i] & 0xFF); // Low byte
     }
 
@@ -514,7 +583,7 @@ namespace Piduino {
     uint8_t lsb = static_cast<uint8_t> (value & 0xFF);
 
     for (int i = 0; i < 4; ++i) {
-      buffer[i * 2] = msb;
+      buffer[i * 2] = msb | (powerDownBits (chan[i].mode) >> 1);
       buffer[i * 2 + 1] = lsb;
     }
     return writeRegisters (buffer, sizeof (buffer)); // Write the buffer to the device
@@ -546,6 +615,47 @@ namespace Piduino {
     return false;
   }
 
+  // ---------------------------------------------------------------------------
+  // internal
+  bool
+  Mcp4728::Private::setupLdac() {
+
+    try {
+      // LDAC low, the outputs follow the input registers
+      ldac->setMode (Pin::ModeOutput);
+      ldac->write (false);
+    }
+    catch (std::exception &e) {
+
+      if (isDebug) {
+        std::cerr << "Mcp4728: " << e.what() << std::endl;
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  // internal
+  // PD1 PD0 bits in the layout of ChannelBuffer::data[0]
+  uint8_t
+  Mcp4728::Private::powerDownBits (Mode m) {
+
+    if (m & PwrDwnEn) {
+      switch (m.value() & PwrDwnMask) {
+        case PwrDwnR1:
+          return PD_1K;
+        case PwrDwnR2:
+          return PD_100K;
+        case PwrDwnR3:
+          return PD_500K;
+        default:
+          break;
+      }
+    }
+    return 0;
+  }
+
   // ---------------------------------------------------------------------------
   // internal
   bool
@@ -608,21 +718,7 @@ namespace Piduino {
     data[0] |= (ch.refId == InternalReference) ? VREF : 0;
     data[0] |= ( (ch.mode & GainMask) == Gain2) ? GX : 0;
 
-    if (ch.mode & PwrDwnEn) {
-      switch (ch.mode.value() & PwrDwnMask) {
-        case PwrDwnR1:
-          data[0] |= PD_1K;
-          break;
-        case PwrDwnR2:
-          data[0] |= PD_100K;
-          break;
-        case PwrDwnR3:
-          data[0] |= PD_500K;
-          break;
-        default:
-          break;
-      }
-    }
+    data[0] |= powerDownBits (ch.mode);
 
     if (ch.mode & SaveToEEPROM) {
 
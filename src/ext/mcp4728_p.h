@@ -17,6 +17,7 @@
 #pragma once
 
 #include <piduino/mcp4728.h>
+#include <piduino/gpiopin.h>
 #include "converter_p.h"
 
 namespace Piduino {
@@ -106,6 +107,14 @@ namespace Piduino {
       */
       virtual bool writeChannel (long value, int channel = -1, bool noUpdate = false) override;
 
+      /**
+         @brief Writes the selected channels in a single fast write frame.
+         @param values Array of 4 values indexed by channel number, clamped by this function.
+         @param mask Selected channels, bit n for channel n.
+         @return True if the frame was successfully written, false otherwise.
+      */
+      virtual bool writeChannels (const long *values, unsigned long mask) override;
+
 
       /**
          @brief Returns the current mode of a channel.
@@ -356,12 +365,15 @@ namespace Piduino {
         return writeRegisters (reinterpret_cast<const uint8_t *> (&buffer), sizeof (ChannelBuffer));
       }
       bool updateSetup();
+      bool setupLdac();
+      static uint8_t powerDownBits (Mode m);
 
       // --------------------------- data members ---------------------------
       std::shared_ptr<I2cDev> i2c; ///< I2C device pointer
       uint16_t addr; ///< I2C slave address
       mutable bool isConnected; ///< Connection status flag, updated after each I2C transaction.
       bool modeSetByUser; ///< Flag to indicate if the mode was set by the user
+      Pin *ldac; ///< Pin connected to LDAC, nullptr if LDAC is tied to ground
 
       std::array<Channel, NofChannels> chan; ///< Array of channel information
 
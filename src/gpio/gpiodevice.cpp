@@ -92,44 +92,49 @@ namespace Piduino {
 
   // -----------------------------------------------------------------------------
   Pin::Pull
-  GpioDevice::pull (const Pin *pin) const {
+  GpioDevice::pull (const Pin */*pin*/) const {
 
     return Pin::PullUnknown;
   }
 
   // -----------------------------------------------------------------------------
   void
-  GpioDevice::setDrive (const Pin *pin, int d) {
+  GpioDevice::setDrive (const Pin */*pin*/, int /*d*/) {
 
   }
 
   // -----------------------------------------------------------------------------
   int
-  GpioDevice::drive (const Pin *pin) const {
+  GpioDevice::drive (const Pin */*pin*/) const {
 
     return -1;
   }
 
   // -----------------------------------------------------------------------------
-  int GpioDevice::waitForInterrupt (const Pin *pin, Pin::Edge edge, int timeout_ms) {
+  int GpioDevice::waitForInterrupt (const Pin */*pin*/, Pin::Edge /*edge*/, int /*timeout_ms*/) {
     return -1;
   }
 
   // -----------------------------------------------------------------------------
-  void GpioDevice::setDebounce (const Pin *pin, uint32_t debounce_ms) {
+  void GpioDevice::setDebounce (const Pin */*pin*/, uint32_t /*debounce_ms*/) {
   }
 
   // -----------------------------------------------------------------------------
-  uint32_t GpioDevice::debounce (const Pin *pin) const {
+  uint32_t GpioDevice::debounce (const Pin */*pin*/) const {
     return 0;
   }
 
   // -----------------------------------------------------------------------------
-  void GpioDevice::setActiveLow (const Pin *pin, bool activeLow) {
+  void GpioDevice::setActiveLow (const Pin */*pin*/, bool /*activeLow*/) {
   }
 
   // -----------------------------------------------------------------------------
-  bool GpioDevice::isActiveLow (const Pin *pin) const {
+  bool GpioDevice::isActiveLow (const Pin */*pin*/) const {
+    return false;
+  }
+
+  // -----------------------------------------------------------------------------
+  bool GpioDevice::portAccess (const Pin */*pin*/, Pin::Port &/*port*/) const {
     return false;
   }
 
@@ -512,6 +512,22 @@ namespace Piduino {
     }
   }
 
+  // ---------------------------------------------------------------------------
+  // Gets a direct handle on the data registers of the pin
+  bool
+  Pin::port (Port &port) const {
+
+    if (isOpen() && (type() == TypeGpio)) {
+      PIMP_D (const Pin);
+
+      if (!d->isGpioDevOpen() && (device()->flags() & GpioDevice::hasPortAccess)) {
+
+        return device()->portAccess (this, port);
+      }
+    }
+    return false;
+  }
+
   // ---------------------------------------------------------------------------
   // Reads the digital value from the pin
   bool
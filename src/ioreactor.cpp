@@ -0,0 +1,191 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <system_error>
+#include <piduino/scheduler.h>
+#include "ioreactor.h"
+#include "config.h"
+
+namespace Piduino {
+
+  // ---------------------------------------------------------------------------
+  IoReactor::IoReactor (int rtPriority) :
+    rtPriority (rtPriority), epfd (-1), evfd (-1), running (false) {}
+
+  // ---------------------------------------------------------------------------
+  IoReactor::~IoReactor() {
+
+    stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  IoReactor &IoReactor::shared() {
+    // never destroyed, the static objects of the library may still remove
+    // their descriptors while the program exits
+    static IoReactor *reactor = new IoReactor;
+
+    return *reactor;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool IoReactor::start() {
+
+    if (running) {
+
+      return true;
+    }
+
+    epfd = ::epoll_create1 (EPOLL_CLOEXEC);
+    if (epfd < 0) {
+
+      return false;
+    }
+    evfd = ::eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (evfd >= 0) {
+      struct epoll_event ev = {};
+
+      ev.events = EPOLLIN;
+      ev.data.fd = evfd;
+      if (::epoll_ctl (epfd, EPOLL_CTL_ADD, evfd, &ev) == 0) {
+
+        try {
+
+          running = true;
+          thread = std::thread (run, this);
+          return true;
+        }
+        catch (std::system_error &e) {
+
+          running = false;
+          errno = EAGAIN;
+        }
+      }
+      ::close (evfd);
+      evfd = -1;
+    }
+    ::close (epfd);
+    epfd = -1;
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  void IoReactor::stop() {
+
+    if (running) {
+      uint64_t one = 1;
+
+      running = false;
+      if (::write (evfd, &one, sizeof (one)) < 0) {
+        // the counter can not overflow here
+      }
+      thread.join();
+      ::close (evfd);
+      ::close (epfd);
+      evfd = epfd = -1;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  bool IoReactor::add (int fd, Handler handler) {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
+    struct epoll_event ev = {};
+
+    if (!start()) {
+
+      return false;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (::epoll_ctl (epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+
+      return false;
+    }
+    handlers[fd] = handler;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  void IoReactor::remove (int fd) {
+    // waits for a handler in progress, the thread holds the mutex while calling it
+    std::lock_guard<std::recursive_mutex> lock (mutex);
+
+    if (handlers.erase (fd) && epfd >= 0) {
+
+      ::epoll_ctl (epfd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t IoReactor::size() const {
+    std::lock_guard<std::recursive_mutex> lock (mutex);
+
+    return handlers.size();
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  void IoReactor::run (IoReactor *r) {
+    struct epoll_event events[16];
+
+    if (r->rtPriority > 0) {
+
+      try {
+
+        Scheduler::setRtPriority (r->rtPriority);
+      }
+      catch (std::system_error &e) {
+        // runs with the normal scheduling
+      }
+    }
+
+    for (;;) {
+      int n = ::epoll_wait (r->epfd, events, 16, -1);
+
+      if (n < 0) {
+
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+
+      for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+
+        if (fd == r->evfd) {
+
+          return;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock (r->mutex);
+        auto h = r->handlers.find (fd);
+        if (h != r->handlers.end()) {
+          // copied, the handler may remove itself
+          Handler handler = h->second;
+
+          handler (events[i].events);
+        }
+      }
+    }
+  }
+}
+/* ========================================================================== */
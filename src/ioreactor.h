@@ -0,0 +1,85 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+namespace Piduino {
+
+  /**
+     @brief epoll event loop serving several file descriptors (internal).
+
+     The thread is started by the first add() and sleeps in epoll_wait() as
+     long as no descriptor is ready, an eventfd wakes it up to stop. The
+     handlers are called by the thread of the reactor with the events of
+     epoll (EPOLLIN, EPOLLHUP...). remove() waits for the end of a handler
+     in progress on the descriptor, so the handler data can be destroyed as
+     soon as it returns, remove() can also be called from a handler.
+
+     shared() is the reactor of the library, used by all the terminals
+     unless they ask for a dedicated thread.
+  */
+  class IoReactor {
+    public:
+      typedef std::function<void (uint32_t events)> Handler;
+
+      /**
+         @param rtPriority real-time priority of the thread, 0 for the normal scheduling
+      */
+      explicit IoReactor (int rtPriority = 0);
+      ~IoReactor();
+
+      /**
+         @brief Reactor shared by the library.
+      */
+      static IoReactor &shared();
+
+      /**
+         @brief Adds a descriptor, polled for input.
+         @return false and errno on error
+      */
+      bool add (int fd, Handler handler);
+
+      /**
+         @brief Removes a descriptor, its handler is no longer called on return.
+      */
+      void remove (int fd);
+
+      /**
+         @brief Number of descriptors served.
+      */
+      size_t size() const;
+
+    private:
+      bool start();
+      void stop();
+      static void run (IoReactor *r);
+
+      int rtPriority;
+      int epfd;
+      int evfd; ///< eventfd, stops the thread
+      bool running;
+      std::thread thread;
+      mutable std::recursive_mutex mutex;
+      std::map<int, Handler> handlers;
+  };
+}
+/* ========================================================================== */
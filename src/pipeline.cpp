@@ -0,0 +1,904 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include "pipeline_p.h"
+#include "config.h"
+
+namespace Piduino {
+
+  // ---------------------------------------------------------------------------
+  //
+  //                             Pipeline Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Pipeline (Pipeline::Private &dd) : d_ptr (&dd) {
+
+  }
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Pipeline (Converter *source, int first, int last) :
+    d_ptr (new Private (this, source, false, first, last)) {
+
+  }
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Pipeline (const std::string &sourceSpec, int first, int last) :
+    d_ptr (new Private (this, Converter::factory (sourceSpec), true, first, last)) {
+
+  }
+
+  // ---------------------------------------------------------------------------
+  Pipeline::~Pipeline() {
+
+    stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  Converter *
+  Pipeline::source() const {
+
+    return d_ptr->source;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::addStage (Stage *stage) {
+
+    if (isRunning() || !stage) {
+
+      return false;
+    }
+    d_ptr->stages.emplace_back (stage);
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::addStage (const std::string &spec) {
+
+    if (isRunning()) {
+
+      return false;
+    }
+    return addStage (stageFactory (spec));
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::addSink (Sink *sink) {
+
+    if (isRunning() || !sink) {
+
+      return false;
+    }
+    d_ptr->sinks.emplace_back (sink);
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::addSink (const std::string &spec) {
+
+    if (isRunning()) {
+
+      return false;
+    }
+    return addSink (sinkFactory (spec));
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  Pipeline::Stage *
+  Pipeline::stageFactory (const std::string &spec) {
+    std::map<std::string, std::string> params;
+    std::string name = Private::parseSpec (spec, params);
+
+    try {
+
+      if (name == "lowpass") {
+        double fc = std::stod (params.at ("fc"));
+
+        return (fc > 0) ? new LowPass (fc) : nullptr;
+      }
+
+      size_t n = std::stoul (params.at ("n"));
+      if (n == 0) {
+
+        return nullptr;
+      }
+      if (name == "avg") {
+
+        return new MovingAverage (n);
+      }
+      if (name == "decim") {
+
+        return new Decimator (n);
+      }
+      if (name == "min") {
+
+        return new Window (Window::Min, n);
+      }
+      if (name == "max") {
+
+        return new Window (Window::Max, n);
+      }
+      if (name == "mean") {
+
+        return new Window (Window::Mean, n);
+      }
+      if (name == "rms") {
+
+        return new Window (Window::Rms, n);
+      }
+    }
+    catch (std::exception &e) {
+      // missing or invalid parameter
+    }
+    return nullptr;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  Pipeline::Sink *
+  Pipeline::sinkFactory (const std::string &spec) {
+    std::map<std::string, std::string> params;
+    std::string name = Private::parseSpec (spec, params);
+
+    try {
+
+      if (name == "ring") {
+        auto it = params.find ("size");
+
+        return new RingSink ( (it != params.end()) ? std::stoul (it->second) : 4096);
+      }
+      if (name == "csv" || name == "bin") {
+
+        return new FileSink (params.at ("file"), name == "bin");
+      }
+      if (name == "dac" && spec.size() > 4) {
+        // the rest of the spec is the converter spec
+        Converter *dac = Converter::factory (spec.substr (4));
+
+        return dac ? new ConverterSink (dac, 0, true) : nullptr;
+      }
+    }
+    catch (std::exception &e) {
+      // missing or invalid parameter
+    }
+    return nullptr;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::start (double rate, size_t blockSize) {
+
+    if (isRunning()) {
+
+      return true;
+    }
+    if (! (rate > 0) || blockSize == 0) {
+
+      return false;
+    }
+    return d_ptr->start (rate, blockSize);
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::stop() {
+
+    d_ptr->stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::isRunning() const {
+
+    return d_ptr->running;
+  }
+
+  // ---------------------------------------------------------------------------
+  double
+  Pipeline::outputRate() const {
+
+    return d_ptr->outRate;
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long
+  Pipeline::framesOut() const {
+
+    return d_ptr->framesOut;
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long
+  Pipeline::droppedScans() const {
+
+    return d_ptr->dropped;
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                         Pipeline::Private Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Private::Private (Pipeline *q, Converter *source, bool owner, int first, int last) :
+    q_ptr (q), source (source), ownsSource (owner), opened (false),
+    first (first), channels (std::max (last, first) - first + 1),
+    outRate (0), blockSize (0), running (false), fill (0), expected (0),
+    framesOut (0), dropped (0) {}
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Private::~Private() {
+
+    stop();
+    if (ownsSource) {
+
+      delete source;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::Private::start (double rate, size_t size) {
+
+    if (!source) {
+
+      return false;
+    }
+    if (!source->isOpen()) {
+
+      if (!source->open (IoDevice::ReadOnly)) {
+
+        return false;
+      }
+      opened = true;
+    }
+
+    // the rate at the input of each stage is given by the previous ones
+    blockSize = size;
+    outRate = rate;
+    for (auto &stage : stages) {
+
+      stage->prepare (channels, outRate);
+      outRate = stage->outputRate (outRate);
+    }
+    for (auto &sink : sinks) {
+
+      // the stages never output more samples than they receive
+      if (!sink->prepare (first, channels, outRate, blockSize)) {
+
+        if (source->isDebug()) {
+          std::cerr << "Pipeline: unable to prepare a sink" << std::endl;
+        }
+        closeSource();
+        return false;
+      }
+    }
+
+    samples.resize (blockSize * channels);
+    raw.assign (channels, std::vector<long> (blockSize));
+    values.assign (channels, std::vector<double> (blockSize));
+    ptrs.resize (channels);
+    for (int c = 0; c < channels; c++) {
+
+      ptrs[c] = values[c].data();
+    }
+    fill = 0;
+    expected = 0;
+    framesOut = 0;
+    dropped = 0;
+
+    // the stream must hold several blocks, the thread polls twice per block
+    int capacity = static_cast<int> (std::max<size_t> (4096, 4 * blockSize * channels));
+    source->stopAcquisition(); // e.g. started by the rate= option of the spec
+    if (!source->startAcquisition (rate, first, first + channels - 1, capacity)) {
+
+      closeSource();
+      return false;
+    }
+
+    try {
+
+      running = true;
+      thread = std::thread (run, this);
+    }
+    catch (std::system_error &e) {
+
+      running = false;
+      source->stopAcquisition();
+      closeSource();
+      if (source->isDebug()) {
+        std::cerr << "Pipeline: unable to start the processing thread: " << e.what() << std::endl;
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Private::stop() {
+
+    if (thread.joinable()) {
+
+      running = false;
+      thread.join();
+
+      // the samples still in the stream and the last partial block
+      source->stopAcquisition();
+      poll();
+      if (fill > 0) {
+
+        processBlock (fill);
+        fill = 0;
+      }
+      for (auto &sink : sinks) {
+
+        sink->flush();
+      }
+      closeSource();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Private::closeSource() {
+
+    if (opened) {
+
+      source->close();
+      opened = false;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Private::run (Private *d) {
+    const double blockTime = d->blockSize * 1e6 / d->source->acquisitionRate();
+    const auto wait = std::chrono::microseconds (std::max (1000L, static_cast<long> (blockTime / 2)));
+
+    while (d->running) {
+
+      d->poll();
+      std::this_thread::sleep_for (wait);
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Private::poll() {
+    int n;
+
+    while ( (n = source->readStream (samples.data(), static_cast<int> (samples.size()))) > 0) {
+
+      for (int i = 0; i < n; i++) {
+        const Converter::Sample &s = samples[i];
+        int c = s.channel - first;
+
+        if (c != expected) {
+          // samples lost in the stream, the frame restarts at the next scan
+          if (expected != 0) {
+
+            dropped++;
+            expected = 0;
+          }
+          if (c != 0) {
+
+            continue;
+          }
+        }
+
+        raw[c][fill] = s.value;
+        if (++expected == channels) {
+
+          expected = 0;
+          if (++fill == blockSize) {
+
+            processBlock (fill);
+            fill = 0;
+          }
+        }
+      }
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Private::processBlock (size_t count) {
+
+    for (int c = 0; c < channels; c++) {
+
+      source->digitalToValue (raw[c].data(), values[c].data(), count, first + c);
+    }
+
+    for (auto &stage : stages) {
+      size_t out = 0;
+
+      for (int c = 0; c < channels; c++) {
+
+        out = stage->process (c, values[c].data(), count);
+      }
+      count = out;
+      if (count == 0) {
+
+        return;
+      }
+    }
+
+    for (auto &sink : sinks) {
+
+      sink->write (ptrs.data(), count);
+    }
+    framesOut += count;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  std::string
+  Pipeline::Private::parseSpec (const std::string &spec, std::map<std::string, std::string> &params) {
+    std::string::size_type start = spec.find (':');
+    std::string name = spec.substr (0, start);
+
+    while (start != std::string::npos) {
+      std::string::size_type end = spec.find (':', start + 1);
+      std::string token = spec.substr (start + 1, (end == std::string::npos) ? std::string::npos : end - start - 1);
+      std::string::size_type eq = token.find ('=');
+
+      if (!token.empty()) {
+
+        params[token.substr (0, eq)] = (eq == std::string::npos) ? std::string() : token.substr (eq + 1);
+      }
+      start = end;
+    }
+    return name;
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                       Pipeline::MovingAverage Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::MovingAverage::MovingAverage (size_t n) : m_n (std::max<size_t> (n, 1)) {}
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::MovingAverage::prepare (int channels, double /*rate*/) {
+
+    m_history.assign (channels, std::vector<double> (m_n));
+    m_index.assign (channels, 0);
+    m_fill.assign (channels, 0);
+    m_sum.assign (channels, 0);
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t
+  Pipeline::MovingAverage::process (int channel, double *data, size_t count) {
+    std::vector<double> &history = m_history[channel];
+    size_t &index = m_index[channel];
+    size_t &fill = m_fill[channel];
+    double &sum = m_sum[channel];
+
+    for (size_t i = 0; i < count; i++) {
+
+      if (fill == m_n) {
+
+        sum -= history[index];
+      }
+      else {
+
+        fill++;
+      }
+      history[index] = data[i];
+      sum += data[i];
+      index = (index + 1) % m_n;
+      // average of the samples received during the warm-up
+      data[i] = sum / fill;
+    }
+    return count;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::MovingAverage::reset() {
+
+    prepare (static_cast<int> (m_history.size()), 0);
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                         Pipeline::LowPass Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::LowPass::LowPass (double cutoff) : m_cutoff (cutoff), m_alpha (1) {}
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::LowPass::prepare (int channels, double rate) {
+    double rc = 1 / (2 * M_PI * m_cutoff);
+    double dt = 1 / rate;
+
+    m_alpha = dt / (rc + dt);
+    m_state.assign (channels, 0);
+    m_primed.assign (channels, false);
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t
+  Pipeline::LowPass::process (int channel, double *data, size_t count) {
+    double y = m_state[channel];
+    size_t i = 0;
+
+    if (!m_primed[channel] && count > 0) {
+      // starts from the first sample instead of 0
+      y = data[0];
+      m_primed[channel] = true;
+      i = 1;
+    }
+    for (; i < count; i++) {
+
+      y += m_alpha * (data[i] - y);
+      data[i] = y;
+    }
+    m_state[channel] = y;
+    return count;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::LowPass::reset() {
+
+    std::fill (m_state.begin(), m_state.end(), 0);
+    std::fill (m_primed.begin(), m_primed.end(), false);
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                        Pipeline::Decimator Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Decimator::Decimator (size_t n) : m_n (std::max<size_t> (n, 1)) {}
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Decimator::prepare (int channels, double /*rate*/) {
+
+    m_phase.assign (channels, 0);
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t
+  Pipeline::Decimator::process (int channel, double *data, size_t count) {
+    size_t &phase = m_phase[channel];
+    size_t out = 0;
+
+    for (size_t i = 0; i < count; i++) {
+
+      if (phase == 0) {
+
+        data[out++] = data[i];
+      }
+      phase = (phase + 1) % m_n;
+    }
+    return out;
+  }
+
+  // ---------------------------------------------------------------------------
+  double
+  Pipeline::Decimator::outputRate (double rate) const {
+
+    return rate / m_n;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Decimator::reset() {
+
+    std::fill (m_phase.begin(), m_phase.end(), 0);
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                          Pipeline::Window Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::Window::Window (Function function, size_t n) :
+    m_function (function), m_n (std::max<size_t> (n, 1)) {}
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Window::prepare (int channels, double /*rate*/) {
+
+    m_fill.assign (channels, 0);
+    m_acc.assign (channels, 0);
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t
+  Pipeline::Window::process (int channel, double *data, size_t count) {
+    size_t &fill = m_fill[channel];
+    double &acc = m_acc[channel];
+    size_t out = 0;
+
+    for (size_t i = 0; i < count; i++) {
+      double x = data[i];
+
+      switch (m_function) {
+        case Min:
+          acc = (fill == 0) ? x : std::min (acc, x);
+          break;
+        case Max:
+          acc = (fill == 0) ? x : std::max (acc, x);
+          break;
+        case Mean:
+          acc = (fill == 0) ? x : acc + x;
+          break;
+        case Rms:
+          acc = (fill == 0) ? x * x : acc + x * x;
+          break;
+      }
+
+      if (++fill == m_n) {
+
+        switch (m_function) {
+          case Mean:
+            acc /= m_n;
+            break;
+          case Rms:
+            acc = std::sqrt (acc / m_n);
+            break;
+          default:
+            break;
+        }
+        data[out++] = acc;
+        fill = 0;
+      }
+    }
+    return out;
+  }
+
+  // ---------------------------------------------------------------------------
+  double
+  Pipeline::Window::outputRate (double rate) const {
+
+    return rate / m_n;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::Window::reset() {
+
+    std::fill (m_fill.begin(), m_fill.end(), 0);
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                         Pipeline::RingSink Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::RingSink::RingSink (size_t frames) :
+    m_frames (std::max<size_t> (frames, 1)), m_channels (1), m_overruns (0) {}
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::RingSink::prepare (int /*first*/, int channels, double /*rate*/, size_t /*blockSize*/) {
+
+    m_channels = channels;
+    m_ring.reset (new SpscRing<double> (m_frames * channels));
+    m_overruns = 0;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::RingSink::write (const double *const *data, size_t count) {
+
+    for (size_t i = 0; i < count; i++) {
+
+      // whole frames only, the reader never sees a partial frame
+      if (m_ring->space() < static_cast<size_t> (m_channels)) {
+
+        m_overruns += count - i;
+        return false;
+      }
+      for (int c = 0; c < m_channels; c++) {
+
+        m_ring->push (data[c][i]);
+      }
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t
+  Pipeline::RingSink::read (double *frames, size_t count) {
+
+    if (!m_ring) {
+
+      return 0;
+    }
+    count = std::min (count, available());
+    return m_ring->pop (frames, count * m_channels) / m_channels;
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t
+  Pipeline::RingSink::available() const {
+
+    return m_ring ? m_ring->size() / m_channels : 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                         Pipeline::FileSink Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::FileSink::FileSink (const std::string &path, bool binary) :
+    m_path (path), m_binary (binary), m_channels (1) {}
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::FileSink::prepare (int first, int channels, double /*rate*/, size_t /*blockSize*/) {
+
+    m_channels = channels;
+    if (m_file.is_open()) {
+
+      m_file.close();
+    }
+    m_file.open (m_path, m_binary ? std::ios::out | std::ios::binary | std::ios::trunc : std::ios::out | std::ios::trunc);
+    if (!m_file.is_open()) {
+
+      return false;
+    }
+    if (!m_binary) {
+      // header with the channel numbers
+      for (int c = 0; c < channels; c++) {
+
+        m_file << (c ? "," : "") << "ch" << first + c;
+      }
+      m_file << '\n';
+      m_file.precision (std::numeric_limits<double>::digits10);
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::FileSink::write (const double *const *data, size_t count) {
+
+    for (size_t i = 0; i < count; i++) {
+
+      for (int c = 0; c < m_channels; c++) {
+
+        if (m_binary) {
+
+          m_file.write (reinterpret_cast<const char *> (&data[c][i]), sizeof (double));
+        }
+        else {
+
+          m_file << (c ? "," : "") << data[c][i];
+        }
+      }
+      if (!m_binary) {
+
+        m_file << '\n';
+      }
+    }
+    return m_file.good();
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  Pipeline::FileSink::flush() {
+
+    m_file.flush();
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                       Pipeline::ConverterSink Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  Pipeline::ConverterSink::ConverterSink (Converter *dac, int first, bool owner) :
+    m_dac (dac), m_first (first), m_owner (owner), m_channels (0), m_mask (0), m_blockSize (0) {}
+
+  // ---------------------------------------------------------------------------
+  Pipeline::ConverterSink::~ConverterSink() {
+
+    if (m_owner) {
+
+      delete m_dac;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::ConverterSink::prepare (int /*first*/, int channels, double /*rate*/, size_t blockSize) {
+
+    if (!m_dac || m_dac->type() != Converter::DigitalToAnalog ||
+        m_first + channels > m_dac->numberOfChannels()) {
+
+      return false;
+    }
+    if (!m_dac->isOpen() && !m_dac->open (IoDevice::WriteOnly)) {
+
+      return false;
+    }
+
+    m_channels = channels;
+    m_mask = 0;
+    for (int c = 0; c < channels; c++) {
+
+      m_mask |= 1UL << (m_first + c);
+    }
+    // the conversion buffers are not resized by the processing thread
+    m_blockSize = std::max<size_t> (blockSize, 1);
+    m_digital.assign (channels, std::vector<long> (m_blockSize));
+    m_frame.assign (m_dac->numberOfChannels(), 0);
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  Pipeline::ConverterSink::write (const double *const *data, size_t count) {
+    bool success = true;
+
+    for (size_t done = 0; done < count;) {
+      size_t n = std::min (m_blockSize, count - done);
+
+      for (int c = 0; c < m_channels; c++) {
+
+        m_dac->valueToDigital (data[c] + done, m_digital[c].data(), n, m_first + c);
+      }
+
+      for (size_t i = 0; i < n; i++) {
+
+        for (int c = 0; c < m_channels; c++) {
+
+          m_frame[m_first + c] = m_digital[c][i];
+        }
+        success = m_dac->writeChannels (m_frame.data(), m_mask) && success;
+      }
+      done += n;
+    }
+    return success;
+  }
+}
+/* ========================================================================== */
@@ -0,0 +1,73 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <map>
+#include <atomic>
+#include <thread>
+#include <piduino/pipeline.h>
+
+namespace Piduino {
+
+  class Pipeline::Private {
+    public:
+      Private (Pipeline *q, Converter *source, bool owner, int first, int last);
+      virtual ~Private();
+
+      bool start (double rate, size_t blockSize);
+      void stop();
+      // closes the source if it was opened by start()
+      void closeSource();
+      static void run (Private *d);
+
+      // reads the acquisition stream and processes the complete blocks
+      void poll();
+      // converts, filters and publishes the count first frames of the block
+      void processBlock (size_t count);
+
+      // splits "name:key=value:key=value", returns the name
+      static std::string parseSpec (const std::string &spec, std::map<std::string, std::string> &params);
+
+      Pipeline * const q_ptr;
+      Converter *source;
+      bool ownsSource;
+      bool opened; ///< the source was opened by the pipeline
+      const int first;
+      const int channels;
+      std::vector<std::unique_ptr<Stage>> stages;
+      std::vector<std::unique_ptr<Sink>> sinks;
+
+      double outRate;
+      size_t blockSize;
+      std::atomic<bool> running; ///< read by isRunning(), thread is only used by start() and stop()
+      std::thread thread;
+
+      // buffers, allocated by start()
+      std::vector<Converter::Sample> samples;
+      std::vector<std::vector<long>> raw;
+      std::vector<std::vector<double>> values;
+      std::vector<double *> ptrs;
+      size_t fill; ///< complete frames in the block
+      int expected; ///< next expected channel index in the scan
+
+      std::atomic<unsigned long> framesOut;
+      std::atomic<unsigned long> dropped;
+
+      PIMP_DECLARE_PUBLIC (Pipeline)
+  };
+}
+/* ========================================================================== */
@@ -0,0 +1,95 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cerrno>
+#include <algorithm>
+#include <time.h>
+
+namespace Piduino {
+
+  /**
+     @brief Absolute deadline timer for the real-time threads (internal).
+
+     sleepUntil() sleeps on the monotonic clock until \c latency nanoseconds
+     before the deadline, then waits for the remaining time in a busy loop.
+     The latency is calibrated from the measured wake-up latency of
+     clock_nanosleep(), it depends on the kernel and on the priority of the
+     thread, so calibrate() must be called by the thread that uses the timer.
+  */
+  class PreciseTimer {
+    public:
+      PreciseTimer() : latency (0) {}
+
+      /**
+         @brief Current time of the monotonic clock in nanoseconds.
+      */
+      static int64_t now() {
+        struct timespec t;
+
+        clock_gettime (CLOCK_MONOTONIC, &t);
+        return static_cast<int64_t> (t.tv_sec) * 1000000000LL + t.tv_nsec;
+      }
+
+      /**
+         @brief Sleeps until the absolute time deadline, without busy loop.
+      */
+      static void sleepTo (int64_t deadline) {
+        struct timespec ts = { static_cast<time_t> (deadline / 1000000000LL), static_cast<long> (deadline % 1000000000LL) };
+
+        while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+          // restart after a signal
+        }
+      }
+
+      /**
+         @brief Measures the wake-up latency on a few short sleeps, the worst
+         case increased by half is used as the busy wait margin.
+         @param maxLatency upper limit of the margin in nanoseconds
+      */
+      void calibrate (int64_t maxLatency) {
+        int64_t worst = 0;
+
+        for (int i = 0; i < 8; i++) {
+          int64_t deadline = now() + 100000;
+
+          sleepTo (deadline);
+          worst = std::max (worst, now() - deadline);
+        }
+        latency = std::min (worst + worst / 2, maxLatency);
+      }
+
+      /**
+         @brief Waits for the absolute time deadline.
+      */
+      void sleepUntil (int64_t deadline) const {
+        int64_t wake = deadline - latency;
+
+        if (wake > now()) {
+
+          sleepTo (wake);
+        }
+        while (now() < deadline) {
+          // busy wait for the remaining margin
+        }
+      }
+
+      int64_t latency; ///< busy wait margin in nanoseconds
+  };
+}
+/* ========================================================================== */
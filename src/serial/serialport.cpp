@@ -15,6 +15,7 @@
  * Lesser General Public License for more details.
  */
 #include <cstdio>
+#include <chrono>
 #include <algorithm>
 #include <sstream>
 #include <stdlib.h>
@@ -54,6 +55,10 @@ struct termios2 {
 #define BOTHER      0010000
 #endif
 
+#ifndef IBSHIFT
+#define IBSHIFT     16
+#endif
+
 namespace Piduino {
 
 // -----------------------------------------------------------------------------
@@ -330,6 +335,7 @@ namespace Piduino {
     if ( (directions & Output) && (d->settings.outputBaudRate != baudRate)) {
       d->settings.outputBaudRate = baudRate;
       d->settings.updateOneByteTime();
+      d->updateFrameGap();
       hasChanged = true;
     }
     if (isOpen() && hasChanged) {
@@ -517,6 +523,153 @@ namespace Piduino {
     return d->isBreakEnabled;
   }
   
+  // ---------------------------------------------------------------------------
+  bool SerialPort::setLowLatency (bool enable, int rtPriority) {
+    PIMP_D (SerialPort);
+
+    d->lowLatency = enable;
+    d->rtPriority = rtPriority;
+    if (enable) {
+
+      d->readThreshold = 1;
+    }
+
+    if (isOpen()) {
+      bool success = d->setLowLatency();
+
+      return d->setReadThreshold() && success;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SerialPort::isLowLatency() const {
+    PIMP_D (const SerialPort);
+
+    return d->lowLatency;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SerialPort::setReadThreshold (int bytes) {
+    PIMP_D (SerialPort);
+
+    if (bytes < 1 || bytes > 255) {
+
+      d->setError (EINVAL, "Invalid read threshold value");
+      return false;
+    }
+
+    d->readThreshold = bytes;
+    if (isOpen()) {
+
+      return d->setReadThreshold();
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  int SerialPort::readThreshold() const {
+    PIMP_D (const SerialPort);
+
+    return d->readThreshold;
+  }
+
+  // ---------------------------------------------------------------------------
+  SerialPort::Latency SerialPort::measureLatency (int samples, long msTimeout) {
+    Latency lat;
+
+    if ( (openMode() & ReadWrite) == ReadWrite) {
+      PIMP_D (SerialPort);
+      std::string garbage;
+      double sum = 0;
+
+      FileStream::flush();
+      discard (Input);
+      notifier().read (garbage);
+
+      for (int i = 0; i < samples; i++) {
+        const char out = 0x55; // alternate bits
+        char in;
+
+        auto start = std::chrono::steady_clock::now();
+        if (::write (d->fd, &out, 1) != 1) {
+
+          d->setError();
+          break;
+        }
+
+        if (notifier().read (in, msTimeout)) {
+          std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+          double us = std::max (elapsed.count() - d->settings.onebyteTime, 0.0);
+
+          if (lat.samples == 0 || us < lat.min) {
+            lat.min = us;
+          }
+          if (us > lat.max) {
+            lat.max = us;
+          }
+          sum += us;
+          lat.samples++;
+        }
+      }
+
+      if (lat.samples) {
+
+        lat.mean = sum / lat.samples;
+      }
+    }
+    return lat;
+  }
+
+  // ---------------------------------------------------------------------------
+  void SerialPort::setFrameGap (double characters) {
+    PIMP_D (SerialPort);
+
+    d->frameGap = std::max (characters, 0.0);
+    d->updateFrameGap();
+  }
+
+  // ---------------------------------------------------------------------------
+  double SerialPort::frameGap() const {
+    PIMP_D (const SerialPort);
+
+    return d->frameGap;
+  }
+
+  // ---------------------------------------------------------------------------
+  void SerialPort::setRs485Pin (Pin * pin, bool activeHigh) {
+    PIMP_D (SerialPort);
+
+    d->rs485Pin = pin;
+    d->rs485PinActiveHigh = activeHigh;
+    d->rs485Port = Pin::Port();
+#if PIDUINO_WITH_GPIO
+    if (pin) {
+
+      pin->setMode (Pin::ModeOutput);
+      pin->port (d->rs485Port);
+    }
+#endif
+    if (isOpen()) {
+
+      d->setRs485();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  Pin * SerialPort::rs485Pin() const {
+    PIMP_D (const SerialPort);
+
+    return d->rs485Pin;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SerialPort::hasKernelRs485() const {
+    PIMP_D (const SerialPort);
+
+    return d->rs485Kernel;
+  }
+
   // ---------------------------------------------------------------------------
   ssize_t SerialPort::write (const char * data, size_t maxSize) {
     
@@ -529,23 +682,36 @@ namespace Piduino {
     if (openMode() & WriteOnly) {
       PIMP_D (SerialPort);
 
-      if (d->settings.flowControl == Rs485RtsUpControl || d->settings.flowControl == Rs485RtsDownControl) {
+      if (d->isRs485()) {
         ssize_t ret = -1;
 
-        if (d->setRequestToSend (d->settings.flowControl == Rs485RtsDownControl)) {
+        if (d->rs485Kernel) {
+
+          // the driver drives RTS, the write returns when the bytes are queued
+          ret = FileStream::write (data, maxSize);
+          if (ret >= 0 && endl) {
+
+            ret +=  FileStream::write ("\r\n", 2);
+          }
+          FileStream::flush();
+          return ret;
+        }
+
+        if (d->setTransmitterEnabled (true)) {
 
           Clock::delayMicroseconds (d->settings.rs485Delay);
           ret = FileStream::write (data, maxSize);
           if (ret >= 0) {
-            
+
             if (endl) {
-              
+
               ret +=  FileStream::write ("\r\n", 2);
             }
             FileStream::flush();
-            Clock::delayMicroseconds (d->settings.onebyteTime * ret + d->settings.rs485Delay);
-            d->setRequestToSend (d->settings.flowControl != Rs485RtsDownControl) ;
+            d->waitTransmitterEmpty();
+            Clock::delayMicroseconds (d->settings.rs485Delay);
           }
+          d->setTransmitterEnabled (false);
         }
         return ret;
       }
@@ -578,6 +744,7 @@ namespace Piduino {
   // ---------------------------------------------------------------------------
   bool SerialPort::Private::open (OpenMode mode, int additionalPosixFlags) {
 
+    notifier.setDedicatedThread (lowLatency, rtPriority);
     if (Terminal::Private::open (mode, O_NOCTTY | O_NONBLOCK)) {
 
       // Acquire non-blocking exclusive lock
@@ -619,11 +786,17 @@ namespace Piduino {
     setTioParity (&tio, settings.parity);
     setTioStopbits (&tio, settings.stopBits);
     setTioFlowcontrol (&tio, settings.flowControl);
+    setTioReadThreshold (&tio, readThreshold);
 
     if (!setTermios (&tio)) {
       return false;
     }
 
+    if (lowLatency) {
+      // the driver can has not this feature
+      setLowLatency();
+    }
+
     if (!setFlowControl()) {
       return false;
     }
@@ -742,6 +915,7 @@ namespace Piduino {
       success = success && (ioctl (TIOCMGET, &status) == 0);
       status |= TIOCM_DTR | TIOCM_RTS; // TODO: RTS On or Off ?
       success = success && (ioctl (TIOCMSET, &status) == 0);
+      success = success && setRs485();
     }
     return success;
   }
@@ -780,8 +954,8 @@ namespace Piduino {
     // try to clear custom baud rate, using termios v2
     struct termios2 tio2;
     if (ioctl (TCGETS2, &tio2) != -1) {
-      if (tio2.c_cflag & BOTHER) {
-        tio2.c_cflag &= ~BOTHER;
+      if (tio2.c_cflag & (BOTHER | (BOTHER << IBSHIFT))) {
+        tio2.c_cflag &= ~ (BOTHER | (CBAUD << IBSHIFT));
         tio2.c_cflag |= CBAUD;
         ioctl (TCSETS2, &tio2);
       }
@@ -819,27 +993,42 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   bool SerialPort::Private::setCustomBaudRate (int32_t baudRate, Directions directions) {
-
-    if (directions != AllDirections) {
-      setError (EOPNOTSUPP, "Cannot set custom speed for one direction");
-      return false;
-    }
-
     struct termios2 tio2;
 
+    // any rate supported by the driver, each direction can have its own rate
     if (ioctl (TCGETS2, &tio2) != -1) {
-      tio2.c_cflag &= ~CBAUD;
-      tio2.c_cflag |= BOTHER;
 
-      tio2.c_ispeed = baudRate;
-      tio2.c_ospeed = baudRate;
+      if (directions & Output) {
+
+        tio2.c_cflag &= ~CBAUD;
+        tio2.c_cflag |= BOTHER;
+        tio2.c_ospeed = baudRate;
+      }
+      if (directions & Input) {
+
+        tio2.c_cflag &= ~ (CBAUD << IBSHIFT);
+        tio2.c_cflag |= BOTHER << IBSHIFT;
+        tio2.c_ispeed = baudRate;
+      }
 
       if (ioctl (TCSETS2, &tio2) != -1
           && ioctl (TCGETS2, &tio2) != -1) {
+        speed_t actual = (directions & Output) ? tio2.c_ospeed : tio2.c_ispeed;
+
+        if (actual != static_cast<speed_t> (baudRate)) {
+          std::cerr << "Baud rate of serial port " << path
+                    << " is set to " << actual
+                    << " instead of " << baudRate << std::endl;
+        }
         return true;
       }
     }
 
+    if (directions != AllDirections) {
+      setError (EOPNOTSUPP, "Cannot set custom speed for one direction");
+      return false;
+    }
+
     struct serial_struct serial;
 
     if (ioctl (TIOCGSERIAL, &serial) == -1) {
@@ -871,6 +1060,142 @@ namespace Piduino {
     return setStandardBaudRate (B38400, directions);
   }
 
+  // ---------------------------------------------------------------------------
+  bool SerialPort::Private::setLowLatency () {
+    struct serial_struct serial;
+
+    ::memset (&serial, 0, sizeof (serial));
+    if (ioctl (TIOCGSERIAL, &serial) == -1) {
+
+      return false;
+    }
+
+    if (lowLatency) {
+
+      serial.flags |= ASYNC_LOW_LATENCY;
+    }
+    else {
+
+      serial.flags &= ~ASYNC_LOW_LATENCY;
+    }
+    return ioctl (TIOCSSERIAL, &serial) != -1;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SerialPort::Private::setReadThreshold () {
+    termios tio;
+
+    if (!getTermios (&tio)) {
+      return false;
+    }
+    setTioReadThreshold (&tio, readThreshold);
+    return setTermios (&tio);
+  }
+
+  // ---------------------------------------------------------------------------
+  void SerialPort::Private::updateFrameGap() {
+    double us = frameGap * settings.onebyteTime;
+
+    if (frameGap > 0 && settings.inputBaudRate > 19200) {
+
+      // fixed inter-frame delay of the Modbus serial line specification
+      us = std::max (us, frameGap * 1750 / 3.5);
+    }
+    notifier.setFrameGap (static_cast<unsigned long> (us));
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SerialPort::Private::isRs485() const {
+
+    return settings.flowControl == Rs485AfterSendControl ||
+           settings.flowControl == Rs485OnSendControl;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Enables the RS485 mode of the driver if the direction is driven by RTS,
+  // otherwise puts the transceiver in reception
+  bool SerialPort::Private::setRs485() {
+    bool kernel = isRs485() && (rs485Pin == nullptr);
+
+#ifdef TIOCSRS485
+    if (kernel || rs485Kernel) {
+      struct serial_rs485 rs485;
+
+      ::memset (&rs485, 0, sizeof (rs485));
+      if (kernel) {
+
+        rs485.flags = SER_RS485_ENABLED |
+                      (settings.flowControl == Rs485OnSendControl ?
+                       SER_RS485_RTS_ON_SEND : SER_RS485_RTS_AFTER_SEND);
+        // the driver delays are in milliseconds
+        rs485.delay_rts_before_send = settings.rs485Delay / 1000;
+        rs485.delay_rts_after_send = settings.rs485Delay / 1000;
+      }
+      // we don't check on errors because a driver can has not this feature
+      rs485Kernel = (::ioctl (fd, TIOCSRS485, &rs485) == 0) && kernel;
+    }
+#endif
+
+    if (isRs485() && !rs485Kernel) {
+
+      return setTransmitterEnabled (false);
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SerialPort::Private::setTransmitterEnabled (bool enable) {
+
+#if PIDUINO_WITH_GPIO
+    if (rs485Pin) {
+      bool level = (enable == rs485PinActiveHigh);
+
+      if (rs485Port.isValid()) {
+
+        rs485Port.write (level);
+      }
+      else {
+
+        rs485Pin->write (level);
+      }
+      return true;
+    }
+#endif
+    // RTS true is the low level on the line
+    return setRequestToSend ( (settings.flowControl == Rs485OnSendControl) == enable);
+  }
+
+  // ---------------------------------------------------------------------------
+  // sleeps while the driver sends its queue, then polls the line status
+  // register until the last stop bit is sent
+  void SerialPort::Private::waitTransmitterEmpty() {
+    int queued;
+    unsigned int lsr;
+
+    while (::ioctl (fd, TIOCOUTQ, &queued) == 0 && queued > 1) {
+
+      Clock::delayMicroseconds (settings.onebyteTime * (queued - 1));
+    }
+
+    if (::ioctl (fd, TIOCSERGETLSR, &lsr) < 0) {
+
+      // the FIFO of the UART is not known, up to 64 bytes
+      Clock::delayMicroseconds (settings.onebyteTime * 64);
+      return;
+    }
+
+    // at most the time of a full FIFO
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds (settings.onebyteTime * 64 + 1000);
+
+    while (! (lsr & TIOCSER_TEMT) && std::chrono::steady_clock::now() < deadline) {
+
+      if (::ioctl (fd, TIOCSERGETLSR, &lsr) < 0) {
+        break;
+      }
+    }
+  }
+
   // ---------------------------------------------------------------------------
   SerialPort::PinoutSignals SerialPort::Private::pinoutSignals() {
     int arg = 0;
@@ -1040,6 +1365,15 @@ namespace Piduino {
     }
   }
 
+  // ---------------------------------------------------------------------------
+  // With VTIME = 0, poll() and epoll() report the terminal readable once VMIN
+  // bytes are received (n_tty), so VMIN is the wake-up threshold of the reader
+  void SerialPort::Private::setTioReadThreshold (termios *tio, int bytes) {
+
+    tio->c_cc[VTIME] = 0;
+    tio->c_cc[VMIN] = bytes;
+  }
+
   // ---------------------------------------------------------------------------
   void SerialPort::Private::setTioDatabits (termios *tio, DataBits databits) {
 
@@ -19,6 +19,7 @@
 #include <termios.h>
 #include <string>
 #include <piduino/serialport.h>
+#include <piduino/gpiopin.h>
 #include "terminal_p.h"
 
 namespace Piduino {
@@ -48,6 +49,13 @@ namespace Piduino {
 
       bool sendBreak (int duration);
       bool setBreakEnabled (bool set);
+      bool setLowLatency ();
+      bool setReadThreshold ();
+      void updateFrameGap();
+      bool isRs485() const;
+      bool setRs485();
+      bool setTransmitterEnabled (bool enable);
+      void waitTransmitterEmpty();
 
       bool initialize (OpenMode mode);
       bool setStandardBaudRate (int32_t baudRate, Directions directions);
@@ -60,6 +68,7 @@ namespace Piduino {
       static void setTioParity (termios * tio, Parity parity);
       static void setTioStopbits (termios * tio, StopBits stopbits);
       static void setTioFlowcontrol (termios * tio, FlowControl flowcontrol);
+      static void setTioReadThreshold (termios * tio, int bytes);
       static int32_t settingFromBaudRate (int32_t baudRate);
 
       static std::string portNameToSystemLocation (const std::string & port);
@@ -69,6 +78,14 @@ namespace Piduino {
       struct termios restoredTermios;
       bool settingsRestoredOnClose = true;
       bool isBreakEnabled = false;
+      bool lowLatency = false;
+      int rtPriority = 0; ///< of the reading thread in low latency mode
+      int readThreshold = 1;
+      double frameGap = 0; ///< in characters
+      bool rs485Kernel = false; ///< TIOCSRS485 accepted by the driver
+      Pin * rs485Pin = nullptr;
+      bool rs485PinActiveHigh = true;
+      Pin::Port rs485Port; ///< register access to rs485Pin, if valid
       Settings settings;
 
       PIMP_DECLARE_PUBLIC (SerialPort)
@@ -25,6 +25,7 @@
 #include <piduino/serialport.h>
 #include "serialportinfo_p.h"
 #include "serialport_p.h"
+#include "ioreactor.h"
 
 #include "config.h"
 
@@ -103,6 +104,203 @@ namespace Piduino {
     return std::string (path);
   }
 
+  // ---------------------------------------------------------------------------
+  // returns nullptr if dev is not a serial port
+  SerialPort::Info::Private *
+  SerialPort::Info::Private::fromDevice (struct udev_device * dev) {
+    struct udev_device * parent = udev_device_get_parent (dev);
+    const char * path = udev_device_get_devnode (dev);
+
+    if (!parent || !path || !isValidSerialPort (path)) {
+
+      return nullptr;
+    }
+
+    Private * p = new Private();
+    const char * driver = udev_device_get_driver (parent);
+
+    p->path.assign (path);
+    p->name.assign (udev_device_get_sysname (dev));
+    p->driver.assign (driver ? driver : "");
+
+    if ( (p->driver.compare ("serial8250") == 0) && isValid8250Device (path))  {
+      const char * value;
+
+      value = udev_device_get_property_value (dev, "ID_MODEL");
+      p->description.assign (value ? value : "");
+      std::replace (p->description.begin(), p->description.end(), '_', ' ');
+
+      value = udev_device_get_property_value (dev, "ID_VENDOR");
+      p->manufacturer.assign (value ? value : "");
+      std::replace (p->manufacturer.begin(), p->manufacturer.end(), '_', ' ');
+
+      value = udev_device_get_property_value (dev, "ID_SERIAL_SHORT");
+      p->serialNumber.assign (value ? value : "");
+      value = udev_device_get_property_value (dev, "ID_VENDOR_ID");
+      p->vendorIdentifier = value ? identifier (value, p->hasVendorIdentifier) : 0;
+      value = udev_device_get_property_value (dev, "ID_MODEL_ID");
+      p->productIdentifier = value ? identifier (value, p->hasProductIdentifier) : 0;
+    }
+    return p;
+  }
+
+// -----------------------------------------------------------------------------
+//
+//                     SerialPort::Info::Private::Cache Class
+//
+// -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  SerialPort::Info::Private::Cache::Cache() :
+    scanned (false), udev (udev_new()), monitorUdev (nullptr), monitor (nullptr) {}
+
+  // ---------------------------------------------------------------------------
+  SerialPort::Info::Private::Cache &
+  SerialPort::Info::Private::Cache::instance() {
+    // never destroyed, the reactor may call onEvent() until the exit
+    static Cache * cache = new Cache;
+
+    return *cache;
+  }
+
+  // ---------------------------------------------------------------------------
+  std::deque<SerialPort::Info> SerialPort::Info::Private::Cache::ports() {
+    std::lock_guard<std::mutex> lock (mutex);
+
+    if (!scanned) {
+
+      scan();
+    }
+    else if (!added.empty()) {
+
+      update();
+    }
+    return list;
+  }
+
+  // ---------------------------------------------------------------------------
+  // mutex must be locked
+  void SerialPort::Info::Private::Cache::scan() {
+
+    if (!udev) {
+      return;
+    }
+
+    if (!monitor) {
+
+      // the monitor is started before the scan, so that no device is missed.
+      // It has its own context, the reactor thread uses it while the thread
+      // of the caller uses udev
+      monitorUdev = udev_new();
+      monitor = monitorUdev ? udev_monitor_new_from_netlink (monitorUdev, "udev") : nullptr;
+      if (monitor) {
+        auto handler = [this] (uint32_t) {
+          onEvent();
+        };
+
+        udev_monitor_filter_add_match_subsystem_devtype (monitor, "tty", nullptr);
+        if (udev_monitor_enable_receiving (monitor) < 0 ||
+            !IoReactor::shared().add (udev_monitor_get_fd (monitor), handler)) {
+
+          // without monitor, the ports are scanned on each query
+          udev_monitor_unref (monitor);
+          monitor = nullptr;
+        }
+      }
+      if (!monitor && monitorUdev) {
+
+        udev_unref (monitorUdev);
+        monitorUdev = nullptr;
+      }
+    }
+
+    struct udev_enumerate * enumerate = udev_enumerate_new (udev);
+    struct udev_list_entry * devices, * entry;
+
+    list.clear();
+    added.clear();
+    udev_enumerate_add_match_subsystem (enumerate, "tty");
+    udev_enumerate_scan_devices (enumerate);
+    devices = udev_enumerate_get_list_entry (enumerate);
+
+    udev_list_entry_foreach (entry, devices) {
+      struct udev_device * dev;
+
+      dev = udev_device_new_from_syspath (udev, udev_list_entry_get_name (entry));
+      if (!dev) {
+        break;
+      }
+
+      Private * p = fromDevice (dev);
+      if (p) {
+
+        list.push_back (Info (*p));
+      }
+      udev_device_unref (dev);
+    }
+    udev_enumerate_unref (enumerate);
+    scanned = (monitor != nullptr);
+  }
+
+  // ---------------------------------------------------------------------------
+  // mutex must be locked, the ports added are checked by the thread of the
+  // caller because the check opens them
+  void SerialPort::Info::Private::Cache::update() {
+
+    for (const auto & syspath : added) {
+      struct udev_device * dev;
+
+      dev = udev_device_new_from_syspath (udev, syspath.c_str());
+      if (dev) {
+        Private * p = fromDevice (dev);
+
+        if (p) {
+          auto same = [p] (const Info & port) {
+            return port.systemLocation() == p->path;
+          };
+
+          list.erase (std::remove_if (list.begin(), list.end(), same), list.end());
+          list.push_back (Info (*p));
+        }
+        udev_device_unref (dev);
+      }
+    }
+    added.clear();
+  }
+
+  // ---------------------------------------------------------------------------
+  void SerialPort::Info::Private::Cache::onEvent() {
+    struct udev_device * dev;
+
+    while ( (dev = udev_monitor_receive_device (monitor)) != nullptr) {
+      const char * action = udev_device_get_action (dev);
+      const char * syspath = udev_device_get_syspath (dev);
+      const char * path = udev_device_get_devnode (dev);
+
+      if (action && syspath) {
+        std::lock_guard<std::mutex> lock (mutex);
+        std::string action_s (action);
+
+        if (action_s == "add") {
+
+          added.push_back (syspath);
+        }
+        else if (action_s == "remove") {
+
+          added.erase (std::remove (added.begin(), added.end(), std::string (syspath)), added.end());
+          if (path) {
+            auto same = [path] (const Info & port) {
+              return port.systemLocation() == path;
+            };
+
+            list.erase (std::remove_if (list.begin(), list.end(), same), list.end());
+          }
+        }
+      }
+      udev_device_unref (dev);
+    }
+  }
+
   // ---------------------------------------------------------------------------
   SerialPort::Info::Info (SerialPort::Info::Private &dd) : d_ptr (&dd) {
 
@@ -248,61 +446,8 @@ namespace Piduino {
   // ---------------------------------------------------------------------------
   std::deque<SerialPort::Info>
   SerialPort::Info::availablePorts () {
-    std::deque<SerialPort::Info> ports;
-    struct udev *udev;
-
-    udev = udev_new();
-    if (udev) {
-      struct udev_enumerate * enumerate;
-      struct udev_list_entry * devices, * dev_list_entry;
-      struct udev_device * dev, * parent;
-
-      enumerate = udev_enumerate_new (udev);
-      udev_enumerate_add_match_subsystem (enumerate, "tty");
-      udev_enumerate_scan_devices (enumerate);
-      devices = udev_enumerate_get_list_entry (enumerate);
-
-      udev_list_entry_foreach (dev_list_entry, devices) {
-
-        dev = udev_device_new_from_syspath (
-                udev, udev_list_entry_get_name (dev_list_entry));
-
-        if (!dev) {
-          break;
-        }
-
-        parent = udev_device_get_parent (dev);
-        if (parent) {
-          const char * path = udev_device_get_devnode (dev);
-
-          if (Private::isValidSerialPort (path)) {
-            Private * p = new Private();
-
-            p->path.assign (path);
-            p->name.assign (udev_device_get_sysname (dev));
-            p->driver.assign (udev_device_get_driver (parent));
-
-            if ( (p->driver.compare ("serial8250") == 0) && Private::isValid8250Device (path))  {
-
-              p->description.assign (udev_device_get_property_value (dev, "ID_MODEL"));
-              std::replace (p->description.begin(), p->description.end(), '_', ' ');
-
-              p->manufacturer.assign (udev_device_get_property_value (dev, "ID_VENDOR"));
-              std::replace (p->manufacturer.begin(), p->manufacturer.end(), '_', ' ');
-
-              p->serialNumber.assign (udev_device_get_property_value (dev, "ID_SERIAL_SHORT"));
-              p->vendorIdentifier = Private::identifier (udev_device_get_property_value (dev, "ID_VENDOR_ID"), p->hasVendorIdentifier);
-              p->productIdentifier = Private::identifier (udev_device_get_property_value (dev, "ID_MODEL_ID"), p->hasProductIdentifier);
-            }
-
-            ports.push_back (*p);
-          }
-        }
-      }
-      udev_unref (udev);
-    }
 
-    return ports;
+    return Private::Cache::instance().ports();
   }
 
   // ---------------------------------------------------------------------------
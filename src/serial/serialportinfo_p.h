@@ -17,6 +17,13 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+struct udev;
+struct udev_device;
+struct udev_monitor;
 
 namespace Piduino {
 
@@ -29,6 +36,32 @@ namespace Piduino {
       static bool isValid8250Device (const char * path);
       static uint16_t identifier (const char * value, bool & hasIdentifier);
       static std::string portIdToSystemLocation (int portId);
+      static Private * fromDevice (struct udev_device * dev);
+
+      /*
+        Ports found by the first scan, then kept current by a udev monitor
+        served by the reactor of the library, never destroyed.
+       */
+      class Cache {
+        public:
+          static Cache & instance();
+          std::deque<Info> ports();
+
+        private:
+          Cache();
+          void scan();
+          void update();
+          // called by the thread of the reactor
+          void onEvent();
+
+          std::mutex mutex;
+          bool scanned;
+          struct udev * udev;
+          struct udev * monitorUdev; ///< context of the monitor, a udev context is not thread-safe
+          struct udev_monitor * monitor; ///< only used by the thread of the reactor once added
+          std::deque<Info> list;
+          std::vector<std::string> added; ///< syspaths to check on the next query
+      };
 
       std::string path;
       std::string name;
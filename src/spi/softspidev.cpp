@@ -0,0 +1,348 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#include <errno.h>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <piduino/softspidev.h>
+#include <piduino/gpio.h>
+#include <piduino/system.h>
+#include "softspidev_p.h"
+#include "../precisetimer.h"
+#include "config.h"
+
+namespace Piduino {
+
+  // -----------------------------------------------------------------------------
+  //
+  //                           SoftSpiBus Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  SoftSpiBus::SoftSpiBus (const SoftSpiDev::Pins &pins) :
+    pins (pins), configured (false) {}
+
+  // ---------------------------------------------------------------------------
+  // static
+  std::mutex &SoftSpiBus::registryMutex() {
+    static std::mutex m;
+
+    return m;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  std::map<int, std::shared_ptr<SoftSpiBus>> &SoftSpiBus::registry() {
+    static std::map<int, std::shared_ptr<SoftSpiBus>> r;
+
+    return r;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  std::shared_ptr<SoftSpiBus> SoftSpiBus::get (int bus) {
+    std::lock_guard<std::mutex> lock (registryMutex());
+    auto it = registry().find (bus);
+
+    return (it != registry().end()) ? it->second : std::shared_ptr<SoftSpiBus>();
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  std::string SoftSpiBus::path (int bus, int cs) {
+    char path[32];
+
+    ::snprintf (path, sizeof (path), "softspi%d.%d", bus, cs);
+    return std::string (path);
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SoftSpiBus::open() {
+    std::lock_guard<std::mutex> lock (mutex);
+
+    if (configured) {
+
+      return true;
+    }
+
+    try {
+
+      if (!gpio.isOpen()) {
+
+        gpio.open();
+      }
+
+      sck.pin = &gpio.pin (pins.sck);
+      sck.pin->setMode (Pin::ModeOutput);
+      sck.pin->port (sck.port);
+
+      if (pins.mosi >= 0) {
+
+        mosi.pin = &gpio.pin (pins.mosi);
+        mosi.pin->setMode (Pin::ModeOutput);
+        mosi.pin->port (mosi.port);
+      }
+
+      if (pins.miso >= 0) {
+
+        miso.pin = &gpio.pin (pins.miso);
+        miso.pin->setMode (Pin::ModeInput);
+        miso.pin->port (miso.port);
+      }
+
+      cs.resize (pins.cs.size());
+      for (size_t i = 0; i < pins.cs.size(); i++) {
+        Line &l = cs[i];
+
+        if (pins.cs[i] >= 0) {
+
+          l.pin = &gpio.pin (pins.cs[i]);
+          l.pin->setMode (Pin::ModeOutput);
+          l.pin->port (l.port);
+          l.write (true); // inactive, SPI_CS_HIGH is only known at the first transfer
+        }
+      }
+    }
+    catch (std::out_of_range &e) {
+
+      errno = ENODEV;
+      return false;
+    }
+    catch (std::system_error &e) {
+
+      errno = e.code().value();
+      return false;
+    }
+
+    configured = true;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  uint32_t SoftSpiBus::exchange (uint32_t out, unsigned int bits, bool lsbFirst,
+                                 bool cpol, bool cpha, int64_t half, int64_t &deadline) {
+    uint32_t in = 0;
+
+    for (unsigned int b = 0; b < bits; b++) {
+      unsigned int shift = lsbFirst ? b : bits - 1 - b;
+      bool bit = (out >> shift) & 1;
+      bool sample;
+
+      if (cpha) {
+        // data changes on the leading edge, sampled on the trailing edge
+        sck.write (!cpol);
+        if (mosi.pin) {
+          mosi.write (bit);
+        }
+        if (half) {
+          deadline += half;
+          while (PreciseTimer::now() < deadline);
+        }
+        sck.write (cpol);
+        sample = miso.pin ? miso.read() : false;
+      }
+      else {
+        // data set before the leading edge, sampled on it
+        if (mosi.pin) {
+          mosi.write (bit);
+        }
+        if (half) {
+          deadline += half;
+          while (PreciseTimer::now() < deadline);
+        }
+        sck.write (!cpol);
+        sample = miso.pin ? miso.read() : false;
+      }
+
+      if (half) {
+        deadline += half;
+        while (PreciseTimer::now() < deadline);
+      }
+      if (!cpha) {
+
+        sck.write (cpol);
+      }
+      in |= static_cast<uint32_t> (sample) << shift;
+    }
+    return in;
+  }
+
+  // ---------------------------------------------------------------------------
+  int SoftSpiBus::transfer (const struct spi_ioc_transfer *xfer, unsigned int nofmsg,
+                            int csId, uint8_t mode, bool msbFirst) {
+    std::lock_guard<std::mutex> lock (mutex);
+    const Line *c = 0;
+    const bool active = (mode & SPI_CS_HIGH) != 0;
+    const bool cpol = (mode & SPI_CPOL) != 0;
+    const bool cpha = (mode & SPI_CPHA) != 0;
+    const bool lsbFirst = (mode & SPI_LSB_FIRST) || !msbFirst;
+    bool selected = false;
+    int total = 0;
+
+    if (!configured) {
+
+      errno = ENOTCONN;
+      return -1;
+    }
+
+    if (! (mode & SPI_NO_CS) && csId >= 0 && csId < static_cast<int> (cs.size()) && cs[csId].pin) {
+
+      c = &cs[csId];
+    }
+
+    sck.write (cpol);
+    for (unsigned int i = 0; i < nofmsg; i++) {
+      const struct spi_ioc_transfer &x = xfer[i];
+      const unsigned int bits = x.bits_per_word ? x.bits_per_word : 8;
+      // words are stored in the smallest power of 2 bytes, in host order, as spidev does
+      const unsigned int bytes = (bits <= 8) ? 1 : ( (bits <= 16) ? 2 : 4);
+      const int64_t half = x.speed_hz ? 500000000LL / x.speed_hz : 0;
+      const uint8_t *tx = reinterpret_cast<const uint8_t *> (static_cast<uintptr_t> (x.tx_buf));
+      uint8_t *rx = reinterpret_cast<uint8_t *> (static_cast<uintptr_t> (x.rx_buf));
+      int64_t deadline = PreciseTimer::now();
+
+      if (bits > 32 || (x.len % bytes)) {
+
+        if (c && selected) {
+          c->write (!active);
+        }
+        errno = EINVAL;
+        return -1;
+      }
+
+      if (c && !selected) {
+
+        c->write (active);
+        selected = true;
+      }
+
+      for (uint32_t offset = 0; offset < x.len; offset += bytes) {
+        uint32_t word = 0;
+
+        if (tx) {
+          memcpy (&word, tx + offset, bytes);
+        }
+        word = exchange (word, bits, lsbFirst, cpol, cpha, half, deadline);
+        if (rx) {
+          memcpy (rx + offset, &word, bytes);
+        }
+      }
+      total += x.len;
+
+      if (x.delay_usecs) {
+        deadline = PreciseTimer::now() + x.delay_usecs * 1000LL;
+        while (PreciseTimer::now() < deadline);
+      }
+
+      // cs_change releases CS between two transfers, or keeps it after the last one
+      bool last = (i + 1 == nofmsg);
+      if (c && (x.cs_change != 0) != last) {
+
+        c->write (!active);
+        selected = false;
+      }
+    }
+    return total;
+  }
+
+  // -----------------------------------------------------------------------------
+  //
+  //                           SoftSpiDev Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  // static
+  bool SoftSpiDev::registerBus (int bus, const Pins &pins) {
+
+    if (bus < 0 || bus >= Info::MaxBuses || pins.sck < 0 || (pins.mosi < 0 && pins.miso < 0)) {
+
+      return false;
+    }
+    if (System::charFileExists (Info::busPath (bus, 0))) {
+      // hardware bus
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock (SoftSpiBus::registryMutex());
+    if (SoftSpiBus::registry().count (bus)) {
+
+      return false;
+    }
+    SoftSpiBus::registry()[bus] = std::make_shared<SoftSpiBus> (pins);
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  void SoftSpiDev::unregisterBus (int bus) {
+    std::lock_guard<std::mutex> lock (SoftSpiBus::registryMutex());
+
+    SoftSpiBus::registry().erase (bus);
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  bool SoftSpiDev::isRegistered (int bus) {
+
+    return SoftSpiBus::get (bus) != nullptr;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  std::vector<int> SoftSpiDev::registeredBuses() {
+    std::lock_guard<std::mutex> lock (SoftSpiBus::registryMutex());
+    std::vector<int> list;
+
+    for (const auto &b : SoftSpiBus::registry()) {
+
+      list.push_back (b.first);
+    }
+    return list;
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  SoftSpiDev::Pins SoftSpiDev::busPins (int bus) {
+    std::shared_ptr<SoftSpiBus> b = SoftSpiBus::get (bus);
+
+    return b ? b->pins : Pins();
+  }
+
+  // ---------------------------------------------------------------------------
+  SoftSpiDev::SoftSpiDev (int bus, int cs) : SpiDev () {
+
+    setBus (Info (bus, cs));
+  }
+
+  // ---------------------------------------------------------------------------
+  SoftSpiDev::SoftSpiDev (int bus, const Pins &pins, int cs) : SpiDev () {
+
+    if (!isRegistered (bus) && !registerBus (bus, pins)) {
+
+      throw std::system_error (EINVAL, std::system_category(),
+                               "Unable to register the software SPI bus " + std::to_string (bus));
+    }
+    setBus (Info (bus, cs));
+  }
+
+  // ---------------------------------------------------------------------------
+  SoftSpiDev::~SoftSpiDev() = default;
+}
+/* ========================================================================== */
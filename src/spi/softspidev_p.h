@@ -0,0 +1,89 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+ * This file is part of the Piduino Library.
+ *
+ * The Piduino Library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Piduino Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <piduino/softspidev.h>
+
+namespace Piduino {
+
+  /**
+   * @brief Générateur des signaux d'un bus logiciel (interne)
+   *
+   * Un objet par bus enregistré, partagé par tous les SpiDev ouverts sur ses
+   * différents CS, les transferts sont sérialisés par \c mutex.
+   */
+  class SoftSpiBus {
+    public:
+      explicit SoftSpiBus (const SoftSpiDev::Pins & pins);
+
+      static std::shared_ptr<SoftSpiBus> get (int bus);
+      static std::string path (int bus, int cs);
+
+      // configures the pins and resolves their ports, returns false and errno on error
+      bool open();
+      // same semantic as SPI_IOC_MESSAGE, returns -1 and errno on error
+      int transfer (const struct spi_ioc_transfer * xfer, unsigned int nofmsg,
+                    int cs, uint8_t mode, bool msbFirst);
+
+      /**
+       * @brief Broche du bus, les registres sont utilisés si possible
+       */
+      class Line {
+        public:
+          Line() : pin (0) {}
+
+          inline void write (bool v) const {
+            if (port.isValid()) {
+              port.write (v);
+            }
+            else {
+              pin->write (v);
+            }
+          }
+
+          inline bool read() const {
+            return port.isValid() ? port.read() : pin->read();
+          }
+
+          Pin * pin; ///< null si la broche n'est pas utilisée
+          Pin::Port port;
+      };
+
+      const SoftSpiDev::Pins pins;
+
+      // function statics, the registry may be used by static SpiDev::Info objects
+      static std::mutex & registryMutex();
+      static std::map<int, std::shared_ptr<SoftSpiBus>> & registry();
+
+    private:
+      uint32_t exchange (uint32_t out, unsigned int bits, bool lsbFirst,
+                         bool cpol, bool cpha, int64_t half, int64_t & deadline);
+
+      std::mutex mutex;
+      bool configured;
+      Line sck;
+      Line mosi;
+      Line miso;
+      std::vector<Line> cs;
+  };
+}
+/* ========================================================================== */
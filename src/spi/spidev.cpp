@@ -21,10 +21,18 @@
 #include <libudev.h>
 #include <cstdio>
 #include <cstring>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <iostream>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <system_error>
 #include <piduino/spidev.h>
+#include <piduino/softspidev.h>
 #include <piduino/gpio.h>
+#include <piduino/scheduler.h>
 #include <piduino/database.h>
 #include <piduino/system.h>
 #include "spidev_p.h"
@@ -42,7 +50,7 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   SpiDev::Private::Private (SpiDev *q) :
-    IoDevice::Private (q), fd (-1) {
+    IoDevice::Private (q), fd (-1), stackMessage (8), maxTransfer (4096), lockCount (0) {
 
     isSequential = true;
   }
@@ -51,11 +59,11 @@ namespace Piduino {
   SpiDev::Private::~Private()  {}
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::setMode () {
+  void SpiDev::Private::getMode () {
 
     if (isOpen()) {
 
-      if (::ioctl (fd, SPI_IOC_WR_MODE, &settings.mode) < 0) {
+      if (::ioctl (fd, SPI_IOC_RD_MODE, &settings.mode) < 0) {
 
         setError();
       }
@@ -63,11 +71,11 @@ namespace Piduino {
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::setSpeedHz () {
+  void SpiDev::Private::getSpeedHz () {
 
     if (isOpen()) {
 
-      if (::ioctl (fd, SPI_IOC_WR_MAX_SPEED_HZ, &settings.speedHz) < 0) {
+      if (::ioctl (fd, SPI_IOC_RD_MAX_SPEED_HZ, &settings.speedHz) < 0) {
 
         setError();
       }
@@ -75,11 +83,11 @@ namespace Piduino {
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::setBitsPerWord () {
+  void SpiDev::Private::getBitsPerWord () {
 
     if (isOpen()) {
 
-      if (::ioctl (fd, SPI_IOC_WR_BITS_PER_WORD, &settings.bitsPerWord) < 0) {
+      if (::ioctl (fd, SPI_IOC_RD_BITS_PER_WORD, &settings.bitsPerWord) < 0) {
 
         setError();
       }
@@ -87,88 +95,423 @@ namespace Piduino {
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::setBitOrder () {
+  void SpiDev::Private::getBitOrder () {
 
     if (isOpen()) {
-      uint8_t b = settings.bitOrder ? 0 : 1;
+      uint8_t b;
 
-      if (::ioctl (fd, SPI_IOC_WR_LSB_FIRST, &b) < 0) {
+      if (::ioctl (fd, SPI_IOC_RD_LSB_FIRST, &b) < 0) {
 
         setError();
       }
+      else {
 
+        settings.bitOrder = (b == 0);
+      }
     }
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::getMode () {
+  void SpiDev::Private::getSettings() {
 
-    if (isOpen()) {
+    getMode();
+    getSpeedHz();
+    getBitOrder();
+    getBitsPerWord();
+  }
 
-      if (::ioctl (fd, SPI_IOC_RD_MODE, &settings.mode) < 0) {
+  // ---------------------------------------------------------------------------
+  bool SpiDev::Private::applySettings() {
+    Bus &b = *arbiter;
+    uint8_t lsb = settings.bitOrder ? 0 : 1;
 
-        setError();
+    if (!b.valid) {
+      // first use of the bus, the driver state is unknown
+      if ( (::ioctl (fd, SPI_IOC_WR_MODE, &settings.mode) < 0) ||
+           (::ioctl (fd, SPI_IOC_WR_LSB_FIRST, &lsb) < 0) ||
+           (::ioctl (fd, SPI_IOC_WR_BITS_PER_WORD, &settings.bitsPerWord) < 0) ||
+           (::ioctl (fd, SPI_IOC_WR_MAX_SPEED_HZ, &settings.speedHz) < 0)) {
+
+        return false;
+      }
+      b.mode = settings.mode;
+      b.bitOrder = settings.bitOrder;
+      b.valid = true;
+      return true;
+    }
+
+    // speed and bits per word are given by each spi_ioc_transfer,
+    // only the mode and the bit order belong to the driver
+    if (b.mode != settings.mode) {
+
+      if (::ioctl (fd, SPI_IOC_WR_MODE, &settings.mode) < 0) {
+
+        return false;
+      }
+      b.mode = settings.mode;
+    }
+    if (b.bitOrder != settings.bitOrder) {
+
+      if (::ioctl (fd, SPI_IOC_WR_LSB_FIRST, &lsb) < 0) {
+
+        return false;
       }
+      b.bitOrder = settings.bitOrder;
     }
+    return true;
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::getSpeedHz () {
+  int SpiDev::Private::transfer (const struct spi_ioc_transfer *xfer, unsigned int nofmsg) {
+    int ret = -1;
 
+    clearError();
     if (isOpen()) {
 
-      if (::ioctl (fd, SPI_IOC_RD_MAX_SPEED_HZ, &settings.speedHz) < 0) {
+      std::lock_guard<std::recursive_mutex> lock (arbiter->mutex);
 
-        setError();
+      ret = 0;
+      if (nofmsg) {
+
+        if (soft) {
+
+          ret = soft->transfer (xfer, nofmsg, bus.csId(), settings.mode, settings.bitOrder);
+        }
+        else if (applySettings()) {
+
+          ret = ::ioctl (fd, SPI_IOC_MESSAGE (nofmsg), xfer);
+        }
+        else {
+
+          ret = -1;
+        }
+        if (ret < 0) {
+
+          setError();
+        }
       }
     }
+    else {
+
+      setError (ENOTCONN);
+    }
+    return ret;
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::getBitsPerWord () {
+  int SpiDev::Private::transferChunks (const uint8_t *txbuf, uint8_t *rxbuf, uint32_t len) {
+    std::lock_guard<std::recursive_mutex> lock (arbiter->mutex);
+    int total = 0;
+
+    if (soft) {
+      // no size limit
+      struct spi_ioc_transfer x;
+
+      memset (&x, 0, sizeof (x));
+      x.tx_buf = reinterpret_cast<uintptr_t> (txbuf);
+      x.rx_buf = reinterpret_cast<uintptr_t> (rxbuf);
+      x.len = len;
+      x.speed_hz = settings.speedHz;
+      x.bits_per_word = settings.bitsPerWord;
+      return soft->transfer (&x, 1, bus.csId(), settings.mode, settings.bitOrder);
+    }
 
-    if (isOpen()) {
+    if (!applySettings()) {
 
-      if (::ioctl (fd, SPI_IOC_RD_BITS_PER_WORD, &settings.bitsPerWord) < 0) {
+      return -1;
+    }
 
-        setError();
+    for (uint32_t offset = 0; offset < len;) {
+      uint32_t n = std::min (len - offset, maxTransfer);
+      struct spi_ioc_transfer x;
+
+      memset (&x, 0, sizeof (x));
+      x.tx_buf = txbuf ? reinterpret_cast<uintptr_t> (txbuf + offset) : 0;
+      x.rx_buf = rxbuf ? reinterpret_cast<uintptr_t> (rxbuf + offset) : 0;
+      x.len = n;
+      x.speed_hz = settings.speedHz;
+      x.bits_per_word = settings.bitsPerWord;
+      offset += n;
+      // on the last transfer of a message, cs_change asks the controller
+      // to keep CS asserted until the next message
+      x.cs_change = (offset < len) ? 1 : 0;
+
+      int ret = ::ioctl (fd, SPI_IOC_MESSAGE (1), &x);
+      if (ret < 0) {
+
+        return ret;
       }
+      total += ret;
     }
+    return total;
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::getBitOrder () {
+  // static
+  uint32_t SpiDev::Private::driverBufsiz () {
+    std::ifstream f ("/sys/module/spidev/parameters/bufsiz");
+    uint32_t value = 0;
 
-    if (isOpen()) {
-      uint8_t b;
+    if (f >> value && value > 0) {
 
-      if (::ioctl (fd, SPI_IOC_RD_LSB_FIRST, &b) < 0) {
+      return value;
+    }
+    return 4096; // spidev default
+  }
 
-        setError();
+  // ---------------------------------------------------------------------------
+  // static
+  std::shared_ptr<SpiDev::Private::Bus> SpiDev::Private::Bus::get (const std::string &path) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<Bus>> registry;
+    std::lock_guard<std::mutex> lock (registryMutex);
+
+    std::shared_ptr<Bus> b = registry[path].lock();
+    if (!b) {
+
+      b = std::make_shared<Bus>();
+      registry[path] = b;
+    }
+    return b;
+  }
+
+  // -----------------------------------------------------------------------------
+  //
+  //                     SpiDev::Private::Stream Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  SpiDev::Private::Stream::Stream (SpiDev::Private *d, uint32_t size, int count, const uint8_t *txbuf) :
+    d (d), size (size), count (count), buffers (static_cast<size_t> (size) * count),
+    tx (txbuf ? txbuf : static_cast<const uint8_t *> (0), txbuf ? txbuf + size : static_cast<const uint8_t *> (0)),
+    head (0), tail (0), held (false), running (false), overruns (0) {}
+
+  // ---------------------------------------------------------------------------
+  SpiDev::Private::Stream::~Stream() {
+
+    stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SpiDev::Private::Stream::start() {
+
+    try {
+
+      running = true;
+      thread = std::thread (run, this);
+    }
+    catch (std::system_error &e) {
+
+      running = false;
+      return false;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  void SpiDev::Private::Stream::stop() {
+
+    if (thread.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        running = false;
       }
-      else {
+      cond.notify_all();
+      thread.join();
+    }
+  }
 
-        settings.bitOrder = (b == 0);
+  // ---------------------------------------------------------------------------
+  void SpiDev::Private::Stream::run (Stream *s) {
+    const uint8_t *txbuf = s->tx.empty() ? 0 : s->tx.data();
+
+    try {
+      // same priority as the converter acquisition, below the software PWM (90)
+      Scheduler::setRtPriority (80);
+    }
+    catch (std::system_error &e) {
+
+      if (s->d->isDebug) {
+        std::cerr << "SpiDev: stream runs without real-time priority: " << e.what() << std::endl;
       }
     }
+
+    while (s->running) {
+      uint8_t *buf;
+      {
+        std::unique_lock<std::mutex> lock (s->mutex);
+
+        if (s->head - s->tail == static_cast<unsigned long> (s->count)) {
+          // all buffers are waiting for the consumer
+          s->overruns++;
+          s->cond.wait (lock, [s] {
+            return !s->running || s->head - s->tail < static_cast<unsigned long> (s->count);
+          });
+          if (!s->running) {
+
+            break;
+          }
+        }
+        // the buffer head is free, the consumer only accesses head - 1 and below
+        buf = &s->buffers[ (s->head % s->count) * s->size];
+      }
+
+      if (s->d->transferChunks (txbuf, buf, s->size) < 0) {
+
+        if (s->d->isDebug) {
+          std::cerr << "SpiDev: stream stopped, " << strerror (errno) << std::endl;
+        }
+        std::lock_guard<std::mutex> lock (s->mutex);
+        s->running = false;
+        s->cond.notify_all();
+        break;
+      }
+
+      std::lock_guard<std::mutex> lock (s->mutex);
+      s->head++;
+      s->cond.notify_all();
+    }
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::getSettings() {
+  const uint8_t *SpiDev::Private::Stream::acquire (int timeoutMs) {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    if (held) {
+      // the previous buffer goes back to the thread
+      held = false;
+      tail++;
+      cond.notify_all();
+    }
 
-    getMode();
-    getSpeedHz();
-    getBitOrder();
-    getBitsPerWord();
+    auto ready = [this] {
+      return head != tail || !running;
+    };
+    if (timeoutMs < 0) {
+
+      cond.wait (lock, ready);
+    }
+    else {
+
+      cond.wait_for (lock, std::chrono::milliseconds (timeoutMs), ready);
+    }
+
+    if (head != tail) {
+
+      held = true;
+      return &buffers[ (tail % count) * size];
+    }
+    return 0;
   }
 
   // ---------------------------------------------------------------------------
-  void SpiDev::Private::setSettings() {
+  void SpiDev::Private::Stream::release() {
+    std::lock_guard<std::mutex> lock (mutex);
 
-    setMode();
-    setSpeedHz();
-    setBitOrder();
-    setBitsPerWord();
+    if (held) {
+
+      held = false;
+      tail++;
+      cond.notify_all();
+    }
+  }
+
+  // -----------------------------------------------------------------------------
+  //
+  //                         SpiDev::Message Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  SpiDev::Message::Message (size_t capacity) :
+    _xfer (capacity), _auto (capacity, 0), _size (0) {
+
+    memset (_xfer.data(), 0, sizeof (struct spi_ioc_transfer) * capacity);
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  SpiDev::Message::push (const uint8_t *txbuf, uint8_t *rxbuf, uint32_t len) {
+
+    if (_size < _xfer.size()) {
+      struct spi_ioc_transfer &x = _xfer[_size++];
+
+      memset (&x, 0, sizeof (x));
+      x.tx_buf = reinterpret_cast<uintptr_t> (txbuf);
+      x.rx_buf = reinterpret_cast<uintptr_t> (rxbuf);
+      x.len = len;
+      _auto[_size - 1] = AutoSpeed | AutoBits;
+      return true;
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  SpiDev::Message::push (const Transfer &t) {
+
+    if (push (t.txBuf, t.rxBuf, t.len)) {
+      struct spi_ioc_transfer &x = _xfer[_size - 1];
+
+      x.delay_usecs = t.delayBeforeReleaseCs;
+      x.cs_change = t.releaseCsAfter;
+      setSpeedHz (_size - 1, t.speedHz);
+      setBitsPerWord (_size - 1, t.bitsPerWord);
+      return true;
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  SpiDev::Message::setBuffers (size_t i, const uint8_t *txbuf, uint8_t *rxbuf, uint32_t len) {
+    struct spi_ioc_transfer &x = _xfer.at (i);
+
+    x.tx_buf = reinterpret_cast<uintptr_t> (txbuf);
+    x.rx_buf = reinterpret_cast<uintptr_t> (rxbuf);
+    x.len = len;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  SpiDev::Message::setSpeedHz (size_t i, uint32_t speedHz) {
+
+    _xfer.at (i).speed_hz = speedHz;
+    if (speedHz) {
+      _auto[i] &= ~AutoSpeed;
+    }
+    else {
+      _auto[i] |= AutoSpeed;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  SpiDev::Message::setBitsPerWord (size_t i, uint8_t bitsPerWord) {
+
+    _xfer.at (i).bits_per_word = bitsPerWord;
+    if (bitsPerWord) {
+      _auto[i] &= ~AutoBits;
+    }
+    else {
+      _auto[i] |= AutoBits;
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  SpiDev::Message::applyDefaults (uint32_t speedHz, uint8_t bitsPerWord) {
+
+    for (size_t i = 0; i < _size; i++) {
+
+      if (_auto[i] & AutoSpeed) {
+        _xfer[i].speed_hz = speedHz;
+      }
+      if (_auto[i] & AutoBits) {
+        _xfer[i].bits_per_word = bitsPerWord;
+      }
+    }
   }
 
   // -----------------------------------------------------------------------------
@@ -182,8 +525,16 @@ namespace Piduino {
   SpiDev::Cs::set (bool value) {
 
     if (! _driverControl) {
+      bool level = value ? _activeLevel : !_activeLevel;
 
-      _pin->write ( (value ^ _activeLevel) != 0);
+      if (_port.isValid()) {
+
+        _port.write (level);
+      }
+      else {
+
+        _pin->write (level);
+      }
     }
   }
 
@@ -192,8 +543,9 @@ namespace Piduino {
   SpiDev::Cs::get () const {
 
     if (! _driverControl) {
+      bool level = _port.isValid() ? _port.read() : _pin->read();
 
-      return (_pin->read() ^ _activeLevel) != 0;
+      return level == _activeLevel;
     }
     return false;
   }
@@ -206,6 +558,7 @@ namespace Piduino {
 
       if (enable) {
 
+        _port = Pin::Port();
         _pin->setMode (_mode);
         _driverControl = true;
       }
@@ -216,6 +569,11 @@ namespace Piduino {
           _activeLevel = al;
           _driverControl = false;
           _pin->setMode (Pin::ModeOutput);
+          // resolved once, set() and get() then bypass Pin and GpioDevice
+          if (!_pin->port (_port)) {
+
+            _port = Pin::Port();
+          }
           set (false);
         }
       }
@@ -223,6 +581,109 @@ namespace Piduino {
     return _driverControl;
   }
 
+  // -----------------------------------------------------------------------------
+  //
+  //                         SpiDev::CsGroup Class
+  //
+  // -----------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  int
+  SpiDev::CsGroup::add (const Cs &cs) {
+
+    if (cs.driverControl()) {
+
+      return -1;
+    }
+
+    Member m;
+    m.cs = cs;
+    m.bank = -1;
+
+    if (cs.port().isValid()) {
+      const Pin::Port &p = cs.port();
+
+      for (size_t i = 0; i < _banks.size(); i++) {
+
+        if (_banks[i].port.sameBank (p)) {
+
+          m.bank = i;
+          break;
+        }
+      }
+      if (m.bank < 0) {
+        Bank b;
+
+        b.port = p;
+        b.idleHigh = 0;
+        b.idleLow = 0;
+        m.bank = _banks.size();
+        _banks.push_back (b);
+      }
+
+      Bank &b = _banks[m.bank];
+      if (cs.activeLevel()) {
+
+        b.idleLow |= p.mask;
+      }
+      else {
+
+        b.idleHigh |= p.mask;
+      }
+    }
+    _members.push_back (m);
+    return _members.size() - 1;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  SpiDev::CsGroup::select (int index) {
+    Member *sel = (index >= 0 && index < static_cast<int> (_members.size())) ? &_members[index] : 0;
+
+    // pins without port access first
+    for (Member &m : _members) {
+
+      if ( (m.bank < 0) && (&m != sel)) {
+
+        m.cs.set (false);
+      }
+    }
+
+    // banks without the selected pin are only deselected
+    for (size_t i = 0; i < _banks.size(); i++) {
+      const Bank &b = _banks[i];
+
+      if (!sel || sel->bank != static_cast<int> (i)) {
+
+        b.port.write (b.idleHigh, b.idleLow, true);
+      }
+    }
+
+    if (sel) {
+
+      if (sel->bank < 0) {
+
+        sel->cs.set (true);
+      }
+      else {
+        const Bank &b = _banks[sel->bank];
+        uint32_t mask = sel->cs.port().mask;
+        uint32_t high = b.idleHigh & ~mask;
+        uint32_t low = b.idleLow & ~mask;
+
+        if (sel->cs.activeLevel()) {
+
+          // the other pins are released (low) before this one goes high
+          b.port.write (high | mask, low, false);
+        }
+        else {
+
+          b.port.write (high, low | mask, true);
+        }
+      }
+    }
+  }
+
   // -----------------------------------------------------------------------------
   //
   //                           SpiDev::Info Class
@@ -258,6 +719,26 @@ namespace Piduino {
     _path = busPath (idBus, idCs);
     _csList.clear();
 
+    if (isSoft()) {
+      const SoftSpiDev::Pins pins = SoftSpiDev::busPins (idBus);
+
+      for (size_t i = 0; i < pins.cs.size(); i++) {
+
+        try {
+          Cs cs;
+
+          cs.setId (idCs);
+          cs.setMode (Pin::ModeOutput);
+          cs.setPin (&gpio.pin (pins.cs[i]));
+          _csList[i] = cs;
+        }
+        catch (std::out_of_range &e) {
+          // invalid pin, the transfers do not drive this CS
+        }
+      }
+      return;
+    }
+
     for (int i = 0; i < socCsList.size(); i++) {
       const Pin::SpiCs &socCs = socCsList[i];
 
@@ -272,11 +753,30 @@ namespace Piduino {
     }
   }
 
+  // ---------------------------------------------------------------------------
+  bool
+  SpiDev::Info::exists() const {
+
+    return isSoft() || System::charFileExists (_path);
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  SpiDev::Info::isSoft() const {
+
+    return _path == SoftSpiBus::path (_bus, _cs) && SoftSpiDev::isRegistered (_bus);
+  }
+
   // ---------------------------------------------------------------------------
   string
   SpiDev::Info::busPath (int bus, int cs) {
     char path[256];
 
+    if (SoftSpiDev::isRegistered (bus)) {
+
+      return SoftSpiBus::path (bus, cs);
+    }
+
     ::snprintf (path, sizeof (path), db.board().family().spiSysPath().c_str(), bus, cs);
     return string (path);
   }
@@ -337,6 +837,16 @@ namespace Piduino {
       udev_unref (udev);
     }
 
+    for (int b : SoftSpiDev::registeredBuses()) {
+      const SoftSpiDev::Pins pins = SoftSpiDev::busPins (b);
+      int n = std::max<int> (pins.cs.size(), 1);
+
+      for (int c = 0; c < n; c++) {
+
+        buses.push_back (Info (b, c));
+      }
+    }
+
     return buses;
   }
 
@@ -395,13 +905,34 @@ namespace Piduino {
       PIMP_D (SpiDev);
 
       d->tstack.clear();
-      d->fd = ::open (d->bus.path().c_str(), d->modeToPosixFlags (mode));
-      if (d->fd < 0) {
+      if (d->bus.isSoft()) {
 
-        d->setError();
-        return false;
+        d->soft = SoftSpiBus::get (d->bus.busId());
+        if (!d->soft) {
+
+          d->setError (ENODEV);
+          return false;
+        }
+        if (!d->soft->open()) {
+
+          d->soft.reset();
+          d->setError();
+          return false;
+        }
+        d->maxTransfer = std::numeric_limits<uint32_t>::max();
+      }
+      else {
+
+        d->fd = ::open (d->bus.path().c_str(), d->modeToPosixFlags (mode));
+        if (d->fd < 0) {
+
+          d->setError();
+          return false;
+        }
+        d->maxTransfer = Private::driverBufsiz();
       }
-      d->setSettings();
+      // the settings are applied by the first transfer
+      d->arbiter = Private::Bus::get (d->bus.path());
 
       IoDevice::open (mode);
     }
@@ -415,11 +946,18 @@ namespace Piduino {
     if (isOpen()) {
       PIMP_D (SpiDev);
 
-      if (::close (d->fd)) {
+      stopStream();
+      if (d->soft) {
+
+        d->soft.reset();
+      }
+      else if (::close (d->fd)) {
 
         d->setError();
       }
       d->fd = -1;
+      // a transaction in progress keeps its lock until endTransaction()
+      d->arbiter.reset();
       IoDevice::close();
     }
   }
@@ -539,7 +1077,6 @@ namespace Piduino {
     if (d->settings != settings) {
 
       d->settings = settings;
-      d->setSettings();
     }
   }
 
@@ -550,7 +1087,6 @@ namespace Piduino {
     if (d->settings.mode != mode) {
 
       d->settings.mode = mode;
-      d->setMode();
     }
   }
 
@@ -561,7 +1097,6 @@ namespace Piduino {
     if (d->settings.speedHz != speedHz) {
 
       d->settings.speedHz = speedHz;
-      d->setSpeedHz();
     }
   }
 
@@ -572,7 +1107,6 @@ namespace Piduino {
     if (d->settings.bitsPerWord != bitsPerWord) {
 
       d->settings.bitsPerWord = bitsPerWord;
-      d->setBitsPerWord();
     }
   }
 
@@ -583,7 +1117,6 @@ namespace Piduino {
     if (d->settings.bitOrder != bitOrder) {
 
       d->settings.bitOrder = bitOrder;
-      d->setBitOrder();
     }
   }
 
@@ -604,50 +1137,169 @@ namespace Piduino {
   // ---------------------------------------------------------------------------
   int SpiDev::transfer () {
     PIMP_D (SpiDev);
-    int ret = -1;
+    Message &msg = d->stackMessage;
+
+    if (d->tstack.size() > msg.capacity()) {
+      // only grows, the next transfers of the same size do not allocate
+      msg = Message (d->tstack.size());
+    }
+    msg.clear();
+    for (const Transfer *t : d->tstack) {
+
+      msg.push (*t);
+    }
+    d->tstack.clear();
+    return transfer (msg);
+  }
+
+  // ---------------------------------------------------------------------------
+  int SpiDev::transfer (Message &msg) {
+    PIMP_D (SpiDev);
+
+    msg.applyDefaults (d->settings.speedHz, d->settings.bitsPerWord);
+    return d->transfer (msg.data(), msg.size());
+  }
+
+  // ---------------------------------------------------------------------------
+  void SpiDev::beginTransaction() {
+    PIMP_D (SpiDev);
 
-    d->clearError();
     if (isOpen()) {
 
-      unsigned int nofmsg = d->tstack.size();
-      ret = 0;
+      d->arbiter->mutex.lock();
+      if (d->lockCount++ == 0) {
 
-      if (nofmsg) {
-        struct spi_ioc_transfer *spi_message = new spi_ioc_transfer[nofmsg];
-        memset (spi_message, 0, sizeof (struct spi_ioc_transfer) * nofmsg);
-
-        for (unsigned int i = 0; i < nofmsg; i++)   {
-
-          spi_message[i].rx_buf = reinterpret_cast<uint64_t> (d->tstack[i]->rxBuf);
-          spi_message[i].tx_buf = reinterpret_cast<const uint64_t> (d->tstack[i]->txBuf);
-          spi_message[i].len = d->tstack[i]->len;
-          spi_message[i].speed_hz = d->tstack[i]->speedHz;
-          spi_message[i].delay_usecs = d->tstack[i]->delayBeforeReleaseCs;
-          spi_message[i].bits_per_word = d->tstack[i]->bitsPerWord;
-          spi_message[i].cs_change = d->tstack[i]->releaseCsAfter;
-        }
+        d->locked = d->arbiter;
+      }
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void SpiDev::endTransaction() {
+    PIMP_D (SpiDev);
+
+    if (d->lockCount > 0) {
+
+      d->locked->mutex.unlock();
+      if (--d->lockCount == 0) {
+
+        d->locked.reset();
+      }
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  int SpiDev::transfer (const uint8_t *txbuf, uint8_t *rxbuf, uint32_t len) {
+    PIMP_D (SpiDev);
 
-        ret = ::ioctl (d->fd, SPI_IOC_MESSAGE (nofmsg), spi_message);
+    if (d->tstack.empty()) {
+
+      if (len <= d->maxTransfer) {
+        // single transfer, built on the stack
+        struct spi_ioc_transfer x;
+
+        memset (&x, 0, sizeof (x));
+        x.tx_buf = reinterpret_cast<uintptr_t> (txbuf);
+        x.rx_buf = reinterpret_cast<uintptr_t> (rxbuf);
+        x.len = len;
+        x.speed_hz = d->settings.speedHz;
+        x.bits_per_word = d->settings.bitsPerWord;
+        return d->transfer (&x, 1);
+      }
+
+      // beyond the driver limit, split in several messages
+      int ret = -1;
+
+      d->clearError();
+      if (isOpen()) {
+
+        ret = d->transferChunks (txbuf, rxbuf, len);
         if (ret < 0) {
+
           d->setError();
         }
-        d->tstack.clear();
-        delete[] spi_message;
       }
+      else {
+
+        d->setError (ENOTCONN);
+      }
+      return ret;
     }
-    else {
+
+    Transfer t (txbuf, rxbuf, len);
+    pushTransfer (t);
+    return transfer();
+  }
+
+  // ---------------------------------------------------------------------------
+  uint32_t SpiDev::maxTransferSize() const {
+    PIMP_D (const SpiDev);
+
+    return d->maxTransfer;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SpiDev::startStream (uint32_t bufferSize, int nofBuffers, const uint8_t *txbuf) {
+    PIMP_D (SpiDev);
+
+    stopStream();
+    if (!isOpen()) {
 
       d->setError (ENOTCONN);
+      return false;
     }
-    return ret;
+    if (bufferSize == 0 || nofBuffers < 2) {
+
+      d->setError (EINVAL);
+      return false;
+    }
+
+    d->stream.reset (new Private::Stream (d, bufferSize, nofBuffers, txbuf));
+    if (!d->stream->start()) {
+
+      d->stream.reset();
+      d->setError (EAGAIN);
+      return false;
+    }
+    return true;
   }
 
   // ---------------------------------------------------------------------------
-  int SpiDev::transfer (const uint8_t *txbuf, uint8_t *rxbuf, uint32_t len) {
-    Transfer t (txbuf, rxbuf, len);
+  void SpiDev::stopStream() {
+    PIMP_D (SpiDev);
 
-    pushTransfer (t);
-    return transfer();
+    d->stream.reset();
+  }
+
+  // ---------------------------------------------------------------------------
+  bool SpiDev::isStreaming() const {
+    PIMP_D (const SpiDev);
+
+    return d->stream && d->stream->running;
+  }
+
+  // ---------------------------------------------------------------------------
+  const uint8_t *SpiDev::streamBuffer (int timeoutMs) {
+    PIMP_D (SpiDev);
+
+    return d->stream ? d->stream->acquire (timeoutMs) : 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  void SpiDev::releaseStreamBuffer() {
+    PIMP_D (SpiDev);
+
+    if (d->stream) {
+
+      d->stream->release();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long SpiDev::streamOverruns() const {
+    PIMP_D (const SpiDev);
+
+    return d->stream ? d->stream->overruns.load() : 0;
   }
 
   // ---------------------------------------------------------------------------
@@ -16,8 +16,14 @@
  */
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <piduino/spidev.h>
 #include "iodevice_p.h"
+#include "softspidev_p.h"
 
 namespace Piduino {
 
@@ -32,17 +38,72 @@ namespace Piduino {
       Settings settings;
       Info bus;
       std::vector<Transfer *> tstack;
+      Message stackMessage; ///< transferts de la pile, agrandi si nécessaire
 
-      void setMode ();
-      void setSpeedHz ();
-      void setBitsPerWord ();
-      void setBitOrder ();
-      void setSettings ();
       void getMode ();
       void getSpeedHz ();
       void getBitsPerWord ();
       void getBitOrder ();
       void getSettings ();
+      int transfer (const struct spi_ioc_transfer * xfer, unsigned int nofmsg);
+      // splits at maxTransfer, returns -1 and errno on error, error() is not modified
+      int transferChunks (const uint8_t * txbuf, uint8_t * rxbuf, uint32_t len);
+      static uint32_t driverBufsiz();
+
+      /**
+       * @brief Lecture en continu dans un anneau de buffers
+       */
+      class Stream {
+        public:
+          Stream (SpiDev::Private * d, uint32_t size, int count, const uint8_t * txbuf);
+          ~Stream();
+
+          bool start();
+          void stop();
+          static void run (Stream * s);
+
+          const uint8_t * acquire (int timeoutMs);
+          void release();
+
+          SpiDev::Private * d;
+          const uint32_t size;
+          const int count;
+          std::vector<uint8_t> buffers; ///< count buffers de size octets
+          std::vector<uint8_t> tx; ///< vide si des 0 sont transmis
+          unsigned long head; ///< nombre de buffers remplis
+          unsigned long tail; ///< nombre de buffers rendus par le consommateur
+          bool held; ///< le consommateur détient le buffer tail
+          std::atomic<bool> running;
+          std::atomic<unsigned long> overruns;
+          std::thread thread;
+          std::mutex mutex;
+          std::condition_variable cond;
+      };
+
+      /**
+         @brief État partagé par tous les SpiDev du processus ouverts sur le même fichier /dev
+      */
+      class Bus {
+        public:
+          Bus() : valid (false), mode (0), bitOrder (true) {}
+          static std::shared_ptr<Bus> get (const std::string & path);
+
+          std::recursive_mutex mutex; ///< verrou des transactions
+          // réglages en vigueur dans le driver
+          bool valid;
+          uint8_t mode;
+          bool bitOrder;
+      };
+
+      // must be called with arbiter->mutex locked, returns false and errno on error
+      bool applySettings();
+
+      uint32_t maxTransfer;
+      std::unique_ptr<Stream> stream;
+      std::shared_ptr<Bus> arbiter; ///< valide lorsque le bus est ouvert
+      std::shared_ptr<Bus> locked; ///< bus verrouillé par beginTransaction()
+      std::shared_ptr<SoftSpiBus> soft; ///< bus logiciel, fd n'est alors pas utilisé
+      int lockCount;
 
       PIMP_DECLARE_PUBLIC (SpiDev)
   };
@@ -18,11 +18,14 @@
 #include <cstdio>
 #include <cerrno>
 #include <cstring>
+#include <algorithm>
 #include <unistd.h>
 #include <fcntl.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/timerfd.h>
 #include "terminalnotifier_p.h"
+#include "precisetimer.h"
 #include "config.h"
 
 namespace Piduino {
@@ -39,8 +42,8 @@ namespace Piduino {
   }
 
   // ---------------------------------------------------------------------------
-  TerminalNotifier::TerminalNotifier (FileDevice * io) :
-    d_ptr (new Private (this, io))  {
+  TerminalNotifier::TerminalNotifier (FileDevice * io, size_t bufferSize) :
+    d_ptr (new Private (this, io, bufferSize))  {
 
   }
 
@@ -78,12 +81,41 @@ namespace Piduino {
         return false;
       }
 
-      // Fetch std::future object associated with promise
-      std::future<void> running = d->stopRead.get_future();
+      d->fd = d->io->fd();
+      if (d->dedicated) {
 
-      // Starting Thread & move the future object in lambda function by reference
-      d->readThread = std::thread (&Private::readNotifier, std::move (running), d);
+        d->ownReactor.reset (new IoReactor (d->rtPriority));
+        d->reactor = d->ownReactor.get();
+      }
+      else {
+
+        d->reactor = &IoReactor::shared();
+      }
+
+      auto handler = [d] (uint32_t events) {
+        d->onEvent (events);
+      };
+      auto gapHandler = [d] (uint32_t) {
+        d->onGapTimer();
+      };
 
+      d->gapfd = ::timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+      if (d->gapfd < 0 || !d->reactor->add (d->gapfd, gapHandler) ||
+          !d->reactor->add (d->fd, handler)) {
+
+        if (d->gapfd >= 0) {
+
+          d->reactor->remove (d->gapfd);
+          ::close (d->gapfd);
+          d->gapfd = -1;
+        }
+        tcsetattr (d->fd, TCSANOW, &d->pterm);
+        d->ownReactor.reset();
+        d->reactor = nullptr;
+        return false;
+      }
+      d->frame = Frame();
+      d->running = true;
     }
     return isRunning();
   }
@@ -92,18 +124,37 @@ namespace Piduino {
   void TerminalNotifier::terminate () {
 
     if (isRunning()) {
-
-      // Set the value in promise
-      d_ptr->stopRead.set_value();
-      // Wait for thread to join
-      d_ptr->readThread.join();
+      PIMP_D (TerminalNotifier);
+
+      // on return, the reactor no longer accesses d
+      d->reactor->remove (d->fd);
+      d->reactor->remove (d->gapfd);
+      ::close (d->gapfd);
+      d->gapfd = -1;
+      d->ownReactor.reset();
+      d->reactor = nullptr;
+      d->running = false;
+      tcsetattr (d->fd, TCSANOW, &d->pterm);
     }
   }
 
   // ---------------------------------------------------------------------------
   bool TerminalNotifier::isRunning() const {
 
-    return d_ptr->readThread.joinable();
+    return d_ptr->running;
+  }
+
+  // ---------------------------------------------------------------------------
+  void TerminalNotifier::setDedicatedThread (bool enable, int rtPriority) {
+
+    d_ptr->dedicated = enable;
+    d_ptr->rtPriority = rtPriority;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool TerminalNotifier::hasDedicatedThread() const {
+
+    return d_ptr->dedicated;
   }
 
   // ---------------------------------------------------------------------------
@@ -112,6 +163,18 @@ namespace Piduino {
     return d_ptr->buf.size();
   }
 
+  // ---------------------------------------------------------------------------
+  size_t TerminalNotifier::bufferSize() const {
+
+    return d_ptr->buf.capacity();
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long TerminalNotifier::overruns() const {
+
+    return d_ptr->buf.overruns();
+  }
+
   // ---------------------------------------------------------------------------
   bool TerminalNotifier::read (char & c, long msTimeout) {
 
@@ -126,11 +189,9 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   size_t TerminalNotifier::read (std::string & str, long msTimeout) {
-    std::vector<char> v;
 
-    d_ptr->buf.read (v, msTimeout);
-    str.assign (v.data(), v.size());
-    return str.size();
+    str.clear();
+    return d_ptr->buf.read (str, msTimeout);
   }
 
   // ---------------------------------------------------------------------------
@@ -147,11 +208,89 @@ namespace Piduino {
 
   // ---------------------------------------------------------------------------
   size_t TerminalNotifier::peek (std::string & str, long msTimeout) {
-    std::vector<char> v;
 
-    d_ptr->buf.peek (v, msTimeout);
-    str.assign (v.data(), v.size());
-    return str.size();
+    str.clear();
+    return d_ptr->buf.peek (str, msTimeout);
+  }
+
+  // ---------------------------------------------------------------------------
+  ByteRing::Views TerminalNotifier::views (long msTimeout) {
+
+    return d_ptr->buf.views (msTimeout);
+  }
+
+  // ---------------------------------------------------------------------------
+  void TerminalNotifier::consume (size_t len) {
+
+    d_ptr->buf.consume (len);
+  }
+
+  // ---------------------------------------------------------------------------
+  int64_t TerminalNotifier::lastReceived() const {
+
+    return d_ptr->lastChunk;
+  }
+
+  // ---------------------------------------------------------------------------
+  void TerminalNotifier::setFrameGap (unsigned long us) {
+
+    d_ptr->gap = us;
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long TerminalNotifier::frameGap() const {
+
+    return d_ptr->gap;
+  }
+
+  // ---------------------------------------------------------------------------
+  void TerminalNotifier::setFrameHandler (FrameHandler handler) {
+    PIMP_D (TerminalNotifier);
+    std::lock_guard<std::mutex> lock (d->frameMutex);
+
+    d->handler = handler;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool TerminalNotifier::readFrame (Frame & frame, long msTimeout) {
+    PIMP_D (TerminalNotifier);
+    std::unique_lock<std::mutex> lock (d->frameMutex);
+    auto ready = [d] {
+      return !d->frames.empty();
+    };
+
+    if (msTimeout < 0) {
+
+      d->frameCond.wait (lock, ready);
+    }
+    else if (msTimeout > 0) {
+
+      d->frameCond.wait_for (lock, std::chrono::milliseconds (msTimeout), ready);
+    }
+
+    if (d->frames.empty()) {
+
+      return false;
+    }
+    frame = std::move (d->frames.front());
+    d->frames.pop_front();
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  size_t TerminalNotifier::framesAvailable() const {
+    PIMP_D (const TerminalNotifier);
+    std::lock_guard<std::mutex> lock (d->frameMutex);
+
+    return d->frames.size();
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long TerminalNotifier::droppedFrames() const {
+    PIMP_D (const TerminalNotifier);
+    std::lock_guard<std::mutex> lock (d->frameMutex);
+
+    return d->dropped;
   }
 
 // -----------------------------------------------------------------------------
@@ -161,81 +300,156 @@ namespace Piduino {
 // -----------------------------------------------------------------------------
 
   // ---------------------------------------------------------------------------
-  TerminalNotifier::Private::Private (TerminalNotifier * q, FileDevice * iofile) :
-    q_ptr (q), io (iofile) {}
+  TerminalNotifier::Private::Private (TerminalNotifier * q, FileDevice * iofile, size_t bufferSize) :
+    q_ptr (q), io (iofile), buf (bufferSize), overflow (256), running (false), fd (-1),
+    reactor (nullptr), dedicated (false), rtPriority (0), lastChunk (0), gap (0),
+    gapfd (-1), dropped (0) {}
 
   // ---------------------------------------------------------------------------
   TerminalNotifier::Private::~Private() = default;
 
   // ---------------------------------------------------------------------------
-  void * TerminalNotifier::Private::readNotifier (std::future<void> run, TerminalNotifier::Private * d) {
-    int len = 0;
+  void TerminalNotifier::Private::onEvent (uint32_t events) {
+    int len = available (fd);
+
+    if (len <= 0) {
+
+      if (events & (EPOLLHUP | EPOLLERR | EPOLLIN)) {
+        // terminal closed or hung up, nothing more to read
+        reactor->remove (fd);
+      }
+      return;
+    }
+
+    int64_t now = PreciseTimer::now();
+    lastChunk = now;
+    if (gap > 0) {
 
-    while ( (run.wait_for (std::chrono::milliseconds (1)) == std::future_status::timeout) &&
-            (len >= 0) && (d->io->openMode() & IoDevice::ReadOnly)) {
+      receiveFrame (len, now);
+      return;
+    }
 
-      len = poll (d->io->fd(), 50);
-      if (len > 0) {
-        long ret;
-        std::vector<char> v (len);
+    while (len > 0) {
+      long ret;
+      char *region;
+      size_t n = buf.writeRegion (region);
 
-        ret = d->io->FileDevice::read (v.data(), len);
+      if (n > 0) {
+        // directly in the ring, up to its end or to the unread bytes
+        ret = io->FileDevice::read (region, std::min (static_cast<size_t> (len), n));
         if (ret > 0) {
-          if (ret != len) {
-            v.resize (ret);
-          }
-          d->buf.write (v);
+
+          buf.commit (ret);
         }
       }
+      else {
+        // the ring is full, the bytes are drained and counted as overruns
+        ret = io->FileDevice::read (overflow.data(), std::min (static_cast<size_t> (len), overflow.size()));
+        if (ret > 0) {
+
+          buf.write (overflow.data(), ret);
+        }
+      }
+
+      if (ret <= 0) {
+
+        break;
+      }
+      len -= ret;
     }
-    tcsetattr (d->io->fd(), TCSANOW, &d->pterm);
-    return 0;
   }
 
   // ---------------------------------------------------------------------------
-  int
-  TerminalNotifier::Private::poll (int fd, unsigned long timeout_ms) {
-    int ret;
-    fd_set set;
+  void TerminalNotifier::Private::receiveFrame (int len, int64_t now) {
+    int64_t gapNs = static_cast<int64_t> (gap) * 1000;
 
-    // Initialize the file descriptor set
-    FD_ZERO (&set);
-    FD_SET (fd, &set);
+    if (!frame.data.empty() && (now - frame.end) >= gapNs) {
+      // the gap timer has not been served yet
+      deliverFrame();
+    }
 
-    if (timeout_ms < 0) {
+    while (len > 0) {
+      long ret = io->FileDevice::read (overflow.data(), std::min (static_cast<size_t> (len), overflow.size()));
+
+      if (ret <= 0) {
+
+        break;
+      }
+      if (frame.data.empty()) {
 
-      // select returns 0 if timeout, 1 if input available, -1 if error
-      ret = ::select (FD_SETSIZE, &set, NULL, NULL, NULL);
+        frame.begin = now;
+      }
+      frame.data.append (overflow.data(), ret);
+      len -= ret;
     }
-    else {
-      struct timeval timeout;
-      unsigned long timeout_us = timeout_ms * 1000UL;
+    frame.end = now;
 
-      // Initialize the timeout data structure
-      timeout.tv_sec  = timeout_us / 1000000UL;
-      timeout.tv_usec = timeout_us % 1000000UL;
+    if (frame.data.size() >= buf.capacity()) {
+      // no silence on the line, the frame is delivered as it is
+      deliverFrame();
+    }
+    else if (!frame.data.empty()) {
+      struct itimerspec its = {};
 
-      // select returns 0 if timeout, 1 if input available, -1 if error
-      ret = ::select (FD_SETSIZE, &set, NULL, NULL, &timeout);
+      its.it_value.tv_sec = gapNs / 1000000000LL;
+      its.it_value.tv_nsec = std::max (static_cast<int64_t> (gapNs % 1000000000LL), static_cast<int64_t> (1));
+      ::timerfd_settime (gapfd, 0, &its, nullptr);
     }
+  }
 
-    if (ret == -1) {
-      if (errno == EINTR) {
+  // ---------------------------------------------------------------------------
+  void TerminalNotifier::Private::onGapTimer() {
+    uint64_t expirations;
 
-        ret = 0;
-      }
+    if (::read (gapfd, &expirations, sizeof (expirations)) < 0) {
+      // re-armed before the event was served
+      return;
     }
-    else if ( (ret > 0) && (FD_ISSET (fd, &set))) {
-      int available_data;
 
-      ret = ::ioctl (fd, FIONREAD, &available_data);
-      if (ret == 0) {
+    if (!frame.data.empty() && available (fd) <= 0) {
+      // a byte waiting to be read may have been received before the end of the gap
 
-        ret = available_data;
+      deliverFrame();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void TerminalNotifier::Private::deliverFrame() {
+    FrameHandler h;
+
+    {
+      std::lock_guard<std::mutex> lock (frameMutex);
+
+      if (!handler) {
+
+        if (frames.size() >= MaxQueuedFrames) {
+
+          frames.pop_front();
+          dropped++;
+        }
+        frames.push_back (std::move (frame));
+        frame = Frame();
+        frameCond.notify_all();
+        return;
       }
+      h = handler;
     }
+    // the handler can call the notifier without deadlock
+    h (frame);
+    frame = Frame();
+  }
+
+  // ---------------------------------------------------------------------------
+  // static
+  int
+  TerminalNotifier::Private::available (int fd) {
+    int available_data;
+
+    if (::ioctl (fd, FIONREAD, &available_data) < 0) {
 
-    return ret;
+      return -1;
+    }
+    return available_data;
   }
 }
 /* ========================================================================== */
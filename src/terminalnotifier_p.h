@@ -16,29 +16,53 @@
  */
 #pragma once
 
-#include <future>
-#include <thread>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
 #include <termios.h>
 #include <piduino/global.h>
 #include <piduino/terminalnotifier.h>
-#include <piduino/threadsafebuffer.h>
+#include <piduino/bytering.h>
+#include "ioreactor.h"
 
 namespace Piduino {
 
   class TerminalNotifier::Private {
     public:
 
-      Private (TerminalNotifier * q, FileDevice * iofile);
+      Private (TerminalNotifier * q, FileDevice * iofile, size_t bufferSize);
       virtual ~Private();
-      static void * readNotifier (std::future<void> run, TerminalNotifier::Private * d);
-      static int poll (int fd, unsigned long timeout_ms);
+      // called by the thread of the reactor
+      void onEvent (uint32_t events);
+      void onGapTimer();
+      void receiveFrame (int len, int64_t now);
+      void deliverFrame();
+      static int available (int fd);
 
       TerminalNotifier * const q_ptr;
       FileDevice * io;
       struct termios pterm;
-      ThreadSafeBuffer<char> buf;
-      std::thread readThread;
-      std::promise<void> stopRead;
+      ByteRing buf;
+      std::vector<char> overflow; ///< drains the terminal when buf is full
+      bool running;
+      int fd; ///< descriptor registered in reactor
+      IoReactor * reactor;
+      bool dedicated;
+      int rtPriority;
+      std::unique_ptr<IoReactor> ownReactor; ///< dedicated thread
+      std::atomic<int64_t> lastChunk; ///< reception time of the last chunk
+
+      // framing
+      std::atomic<unsigned long> gap; ///< us, 0 if disabled
+      int gapfd; ///< timerfd, expires after a silence of gap us
+      Frame frame; ///< frame in progress, only used by the thread of the reactor
+      std::deque<Frame> frames;
+      FrameHandler handler;
+      unsigned long dropped;
+      mutable std::mutex frameMutex; ///< protects frames, handler and dropped
+      std::condition_variable frameCond;
 
       PIMP_DECLARE_PUBLIC (TerminalNotifier)
   };
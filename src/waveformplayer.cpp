@@ -0,0 +1,371 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cmath>
+#include <iostream>
+#include <piduino/scheduler.h>
+#include "waveformplayer_p.h"
+#include "config.h"
+
+namespace Piduino {
+
+  // ---------------------------------------------------------------------------
+  //
+  //                          WaveformPlayer Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  WaveformPlayer::WaveformPlayer (WaveformPlayer::Private &dd) : d_ptr (&dd) {
+
+  }
+
+  // ---------------------------------------------------------------------------
+  WaveformPlayer::WaveformPlayer (Converter *dac) :
+    d_ptr (new Private (this, dac)) {
+
+  }
+
+  // ---------------------------------------------------------------------------
+  WaveformPlayer::~WaveformPlayer() {
+
+    stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  Converter *
+  WaveformPlayer::converter() const {
+
+    return d_ptr->dac;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::setTable (int channel, const std::vector<long> &samples) {
+    PIMP_D (WaveformPlayer);
+
+    if (isRunning() || samples.empty() || channel < 0 ||
+        (d->dac && channel >= d->dac->numberOfChannels())) {
+
+      return false;
+    }
+    d->tables[channel] = samples;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::setWaveform (int channel, Shape shape, size_t length, double amplitude, double offset) {
+    PIMP_D (WaveformPlayer);
+
+    if (isRunning() || length == 0 || !d->dac) {
+
+      return false;
+    }
+
+    std::vector<double> values (length);
+    std::vector<long> samples (length);
+
+    for (size_t i = 0; i < length; i++) {
+      double t = static_cast<double> (i) / length; // phase in [0, 1[
+      double v;
+
+      switch (shape) {
+        case Sine:
+          v = std::sin (2 * M_PI * t);
+          break;
+        case Triangle:
+          v = (t < 0.25) ? 4 * t : ( (t < 0.75) ? 2 - 4 * t : 4 * t - 4);
+          break;
+        case Square:
+          v = (t < 0.5) ? 1 : -1;
+          break;
+        default: // Sawtooth
+          v = 2 * t - 1;
+          break;
+      }
+      values[i] = offset + amplitude * v;
+    }
+    // the whole table is converted with the cached scaling of the channel
+    d->dac->valueToDigital (values.data(), samples.data(), length, channel);
+    for (auto &s : samples) {
+
+      s = std::max (d->dac->min(), std::min (d->dac->max(), s));
+    }
+    return setTable (channel, samples);
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::clearTables() {
+
+    if (isRunning()) {
+
+      return false;
+    }
+    d_ptr->tables.clear();
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::setSampleRate (double rate) {
+
+    if (isRunning() || ! (rate > 0)) {
+
+      return false;
+    }
+    d_ptr->rate = rate;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  double
+  WaveformPlayer::sampleRate() const {
+
+    return d_ptr->rate;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::setSamplesPerTransfer (int n) {
+
+    if (isRunning() || n < 1) {
+
+      return false;
+    }
+    d_ptr->samplesPerTransfer = n;
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  int
+  WaveformPlayer::samplesPerTransfer() const {
+
+    return d_ptr->samplesPerTransfer;
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::start() {
+    PIMP_D (WaveformPlayer);
+
+    if (isRunning()) {
+
+      return true;
+    }
+    if (!d->dac || d->dac->type() != Converter::DigitalToAnalog ||
+        ! (d->dac->openMode() & IoDevice::WriteOnly) || d->tables.empty()) {
+
+      return false;
+    }
+    return d->start();
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  WaveformPlayer::stop() {
+
+    d_ptr->stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::isRunning() const {
+
+    return d_ptr->running;
+  }
+
+  // ---------------------------------------------------------------------------
+  double
+  WaveformPlayer::achievedRate() const {
+    PIMP_D (const WaveformPlayer);
+    std::lock_guard<std::mutex> lock (d->statsMutex);
+    int64_t elapsed = d->lastTime - d->startTime;
+
+    return (elapsed > 0) ? d->played * 1e9 / elapsed : 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long
+  WaveformPlayer::samplesPlayed() const {
+    PIMP_D (const WaveformPlayer);
+    std::lock_guard<std::mutex> lock (d->statsMutex);
+
+    return d->played;
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long
+  WaveformPlayer::lateSamples() const {
+    PIMP_D (const WaveformPlayer);
+    std::lock_guard<std::mutex> lock (d->statsMutex);
+
+    return d->late;
+  }
+
+  // ---------------------------------------------------------------------------
+  unsigned long
+  WaveformPlayer::errors() const {
+    PIMP_D (const WaveformPlayer);
+    std::lock_guard<std::mutex> lock (d->statsMutex);
+
+    return d->errors;
+  }
+
+  // ---------------------------------------------------------------------------
+  //
+  //                      WaveformPlayer::Private Class
+  //
+  // ---------------------------------------------------------------------------
+
+  // ---------------------------------------------------------------------------
+  WaveformPlayer::Private::Private (WaveformPlayer *q, Converter *dac) :
+    q_ptr (q), dac (dac), rate (1000), samplesPerTransfer (1), mask (0), running (false),
+    startTime (0), lastTime (0), played (0), late (0), errors (0) {}
+
+  // ---------------------------------------------------------------------------
+  WaveformPlayer::Private::~Private() {
+
+    stop();
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::Private::start() {
+
+    {
+      std::lock_guard<std::mutex> lock (statsMutex);
+
+      startTime = lastTime = 0;
+      played = late = errors = 0;
+    }
+    block.resize (samplesPerTransfer);
+    frame.assign (dac->numberOfChannels(), 0);
+    mask = 0;
+    for (const auto &t : tables) {
+
+      mask |= 1UL << t.first;
+    }
+    try {
+
+      running = true;
+      thread = std::thread (run, this);
+    }
+    catch (std::system_error &e) {
+
+      running = false;
+      if (dac->isDebug()) {
+        std::cerr << "WaveformPlayer: unable to start the playback thread: " << e.what() << std::endl;
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  WaveformPlayer::Private::stop() {
+
+    if (thread.joinable()) {
+
+      running = false;
+      thread.join();
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  bool
+  WaveformPlayer::Private::writeSamples (size_t index, int count) {
+
+    if (count > 1) {
+      // single channel, the samples are packed in one transfer
+      const int channel = tables.begin()->first;
+      const std::vector<long> &table = tables.begin()->second;
+
+      for (int i = 0; i < count; i++) {
+
+        block[i] = table[ (index + i) % table.size()];
+      }
+      return dac->writeBlock (channel, block.data(), count);
+    }
+
+    // all the channels are updated together
+    for (const auto &t : tables) {
+
+      frame[t.first] = t.second[index % t.second.size()];
+    }
+    return dac->writeChannels (frame.data(), mask);
+  }
+
+  // ---------------------------------------------------------------------------
+  void
+  WaveformPlayer::Private::run (Private *d) {
+    const int n = (d->tables.size() == 1) ? d->samplesPerTransfer : 1;
+    const int64_t period = static_cast<int64_t> (1e9 / d->rate);
+    const int64_t transfer = n * period;
+    size_t index = 0;
+
+    try {
+      // same priority as the converter acquisition, below the software PWM (90)
+      Scheduler::setRtPriority (80);
+    }
+    catch (std::system_error &e) {
+
+      if (d->dac->isDebug()) {
+        std::cerr << "WaveformPlayer: playback runs without real-time priority: " << e.what() << std::endl;
+      }
+    }
+    d->timer.calibrate (period / 2);
+
+    int64_t next = PreciseTimer::now() + period;
+    {
+      std::lock_guard<std::mutex> lock (d->statsMutex);
+
+      d->startTime = d->lastTime = next;
+    }
+    while (d->running) {
+
+      d->timer.sleepUntil (next);
+      int64_t start = PreciseTimer::now();
+      bool success = d->writeSamples (index, n);
+      unsigned long late = (start - next > period / 2) ? n : 0;
+      unsigned long skipped = 0;
+
+      // the samples whose deadline has already been passed by more than one
+      // transfer are skipped, to keep the waveform in phase with the clock
+      index += n;
+      next += transfer;
+      int64_t delay = PreciseTimer::now() - next;
+      if (delay >= transfer) {
+
+        skipped = static_cast<unsigned long> (delay / transfer) * n;
+        index += skipped;
+        next += static_cast<int64_t> (skipped) * period;
+      }
+
+      std::lock_guard<std::mutex> lock (d->statsMutex);
+      d->played += n;
+      d->late += late + skipped;
+      d->lastTime = next;
+      if (!success) {
+
+        d->errors++;
+      }
+    }
+  }
+}
+/* ========================================================================== */
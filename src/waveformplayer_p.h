@@ -0,0 +1,62 @@
+/* Copyright © 2018-2025 Pascal JEAN, All rights reserved.
+   This file is part of the Piduino Library.
+
+   The Piduino Library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   The Piduino Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with the Piduino Library; if not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <piduino/waveformplayer.h>
+#include "precisetimer.h"
+
+namespace Piduino {
+
+  class WaveformPlayer::Private {
+    public:
+      Private (WaveformPlayer *q, Converter *dac);
+      virtual ~Private();
+
+      bool start();
+      void stop();
+      static void run (Private *d);
+
+      // writes the samples of the period index of all tables
+      bool writeSamples (size_t index, int count);
+
+      WaveformPlayer * const q_ptr;
+      Converter *dac;
+      std::map<int, std::vector<long>> tables; ///< digital values of each channel
+      double rate;
+      int samplesPerTransfer;
+      std::vector<long> block; ///< preallocated transfer buffer
+      std::vector<long> frame; ///< values of all the channels, indexed by channel
+      unsigned long mask; ///< channels that have a table
+      std::atomic<bool> running; ///< read by isRunning(), thread is only used by start() and stop()
+      std::thread thread;
+      PreciseTimer timer; ///< calibrated by the thread
+
+      mutable std::mutex statsMutex;
+      int64_t startTime;
+      int64_t lastTime;
+      unsigned long played;
+      unsigned long late;
+      unsigned long errors;
+
+      PIMP_DECLARE_PUBLIC (WaveformPlayer)
+  };
+}
+/* ========================================================================== */
@@ -0,0 +1,158 @@
+// Max7311Gpio Unit Test
+// Use UnitTest++ framework -> https://github.com/unittest-cpp/unittest-cpp/wiki
+#include <iostream>
+#include <stdexcept>
+
+#include <piduino/max7311gpio.h>
+
+#include <UnitTest++/UnitTest++.h>
+
+using namespace std;
+using namespace Piduino;
+
+// Configuration settings -----------------------------------
+// MAX7311 with all its lines unconnected, so that the input register gives
+// back the level of the outputs
+const int busId = I2cDev::Info::defaultBus().id(); // I2C bus ID of the expander
+const int address = 0x20; // I2C address of the expander
+
+// -----------------------------------------------------------------------------
+struct TestFixture {
+
+  void begin (int number, const char title[]) {
+    std::cout << std::endl << "--------------------------------------------------------------------------->>>" << std::endl;
+    std::cout << "Test" << number << ": " << title << std::endl;
+  }
+
+  void end() {
+    std::cout << "---------------------------------------------------------------------------<<<" << std::endl << std::endl;
+  }
+};
+
+// -----------------------------------------------------------------------------
+struct GpioFixture: public TestFixture {
+  Max7311Gpio gpio;
+
+  GpioFixture() : gpio (busId, address) {
+
+    gpio.open();
+  }
+
+  ~GpioFixture() {
+
+    gpio.close();
+  }
+};
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (TestFixture, Test1) {
+  Max7311Gpio gpio (busId, address);
+
+  begin (1, "Max7311Gpio properties and line range tests");
+  CHECK_EQUAL (16, Max7311Gpio::NumberOfLines);
+  CHECK_EQUAL (false, gpio.isOpen());
+  CHECK_EQUAL (AccessLayerGpioDev, gpio.preferedAccessLayer());
+  CHECK_EQUAL (GpioDevice::hasToggle | GpioDevice::hasPullRead | GpioDevice::hasActiveLow, gpio.flags());
+  CHECK_EQUAL (0u, gpio.flags() & GpioDevice::hasPortAccess);
+  CHECK_EQUAL (2u, gpio.modes().size());
+  CHECK_EQUAL ("in", gpio.modes().at (Pin::ModeInput));
+  CHECK_EQUAL ("out", gpio.modes().at (Pin::ModeOutput));
+  CHECK (gpio.expander() != nullptr);
+
+  // the line number is checked before any access to the expander
+  CHECK_THROW (gpio.mode (-1), std::out_of_range);
+  CHECK_THROW (gpio.mode (Max7311Gpio::NumberOfLines), std::out_of_range);
+  CHECK_THROW (gpio.write (Max7311Gpio::NumberOfLines, true), std::out_of_range);
+  CHECK_THROW (gpio.read (-1), std::out_of_range);
+  CHECK_THROW (gpio.toggle (Max7311Gpio::NumberOfLines), std::out_of_range);
+  CHECK_THROW (gpio.setMode (Max7311Gpio::NumberOfLines, Pin::ModeOutput), std::out_of_range);
+  CHECK_THROW (gpio.setMode (0, Pin::ModeAlt0), std::invalid_argument);
+  end();
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (GpioFixture, Test2) {
+
+  begin (2, "Max7311Gpio mode tests");
+  CHECK_EQUAL (true, gpio.isOpen());
+
+  for (int line = 0; line < Max7311Gpio::NumberOfLines; line++) {
+
+    gpio.setMode (line, Pin::ModeOutput);
+    CHECK_EQUAL (Pin::ModeOutput, gpio.mode (line));
+    gpio.setMode (line, Pin::ModeInput);
+    CHECK_EQUAL (Pin::ModeInput, gpio.mode (line));
+  }
+  end();
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (GpioFixture, Test3) {
+
+  begin (3, "Max7311Gpio line write, read and toggle tests");
+  CHECK_EQUAL (true, gpio.isOpen());
+
+  for (int line = 0; line < Max7311Gpio::NumberOfLines; line++) {
+
+    gpio.setMode (line, Pin::ModeOutput);
+  }
+
+  for (int line = 0; line < Max7311Gpio::NumberOfLines; line++) {
+
+    // only the line written changes, bit n of the ports is line n
+    gpio.writeAll (0);
+    gpio.write (line, true);
+    CHECK_EQUAL (true, gpio.read (line));
+    CHECK_EQUAL (1 << line, gpio.readAll());
+
+    gpio.toggle (line);
+    CHECK_EQUAL (false, gpio.read (line));
+    gpio.toggle (line);
+    CHECK_EQUAL (true, gpio.read (line));
+  }
+
+  gpio.writeAll (0xA55A);
+  CHECK_EQUAL (0xA55A, gpio.readAll());
+  gpio.writeAll (0);
+  CHECK_EQUAL (0, gpio.readAll());
+  end();
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (GpioFixture, Test4) {
+
+  begin (4, "Max7311Gpio batch tests");
+  CHECK_EQUAL (true, gpio.isOpen());
+
+  for (int line = 0; line < Max7311Gpio::NumberOfLines; line++) {
+
+    gpio.setMode (line, Pin::ModeOutput);
+  }
+  gpio.writeAll (0);
+
+  gpio.beginBatch();
+  CHECK_EQUAL (true, gpio.isBatch());
+  for (int line = 0; line < Max7311Gpio::NumberOfLines; line += 2) {
+
+    gpio.write (line, true);
+  }
+  // the inputs read by beginBatch() are returned until the next update()
+  CHECK_EQUAL (0, gpio.readAll());
+  gpio.sync();
+  gpio.update();
+  CHECK_EQUAL (0x5555, gpio.readAll());
+
+  gpio.writeAll (0xFFFF);
+  gpio.endBatch();
+  CHECK_EQUAL (false, gpio.isBatch());
+  CHECK_EQUAL (0xFFFF, gpio.readAll());
+
+  gpio.writeAll (0);
+  end();
+}
+
+// -----------------------------------------------------------------------------
+int main (int argc, char **argv) {
+
+  return UnitTest::RunAllTests();
+}
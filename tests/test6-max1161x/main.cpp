@@ -5,6 +5,9 @@
 #include <string>
 #include <map>
 #include <limits>
+#include <vector>
+#include <algorithm>
+#include <functional>
 
 #include <piduino/system.h>
 #include <piduino/clock.h>
@@ -572,6 +575,262 @@ TEST_FIXTURE (ConverterFixture, Test5) {
   end();
 }
 
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (ConverterFixture, Test6) {
+  const int numSamples = 50; // Number of samples taken
+  const double absErr = 0.05; // Absolute error tolerance for voltage readings
+  long values[2];
+
+  begin (6, "Max1161x Scan Converter tests");
+
+  conv = std::make_unique<Max1161x>();
+  CHECK (conv != nullptr);
+  conv->setDebug (true);
+
+  std::cout << "Check the voltage on AIN0, it should be 2V ± " << absErr << "V" << std::endl;
+  std::cout << "Check the voltage on AIN1, it should be 1V ± " << absErr << "V" << std::endl;
+
+  conv->setReference (Max1161x::InternalReference);
+  CHECK_EQUAL (true, conv->open());
+
+  long digitalErr = conv->valueToDigital (absErr);  // Convert absolute error to digital value
+
+  // invalid ranges
+  CHECK_EQUAL (false, conv->readChannels (1, 0, values));
+  CHECK_EQUAL (false, conv->readChannels (0, 1, nullptr));
+
+  for (int i = 0; i < numSamples; i++) {
+    // Read AIN0 and AIN1 in a single scan
+    CHECK_EQUAL (true, conv->readChannels (0, 1, values));
+    std::cout << "AIN0: " << values[0] << ", AIN1: " << values[1] << " (Digital)" << std::endl;
+    CHECK_CLOSE (D1Int, values[0], digitalErr);
+    CHECK_CLOSE (D2Int, values[1], digitalErr);
+
+    // Read AIN1 only, AIN0 is converted and discarded
+    CHECK_EQUAL (true, conv->readChannels (1, 1, values));
+    CHECK_CLOSE (D2Int, values[0], digitalErr);
+
+    Clock::delay (10); // Delay between readings
+  }
+
+  // Read all the channels
+  std::vector<long> all (conv->numberOfChannels());
+  CHECK_EQUAL (true, conv->readChannels (0, conv->numberOfChannels() - 1, all.data()));
+  CHECK_CLOSE (D1Int, all[0], digitalErr);
+  CHECK_CLOSE (D2Int, all[1], digitalErr);
+
+  // Out of range
+  CHECK_EQUAL (false, conv->readChannels (0, conv->numberOfChannels(), all.data()));
+  end();
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (ConverterFixture, Test7) {
+  const double absErr = 0.05; // Absolute error tolerance for voltage readings
+
+  begin (7, "Max1161x Hardware Average tests");
+
+  conv = std::make_unique<Max1161x>();
+  CHECK (conv != nullptr);
+  conv->setDebug (true);
+
+  std::cout << "Check the voltage on AIN0, it should be 2V ± " << absErr << "V" << std::endl;
+  std::cout << "Check the voltage on AIN1, it should be 1V ± " << absErr << "V" << std::endl;
+
+  conv->setReference (Max1161x::InternalReference);
+  CHECK_EQUAL (true, conv->open());
+
+  long digitalErr = conv->valueToDigital (absErr);  // Convert absolute error to digital value
+
+  // 8 samples: a single burst, 20 samples: 3 bursts, 3 samples: partial burst
+  const int counts[] = { 8, 20, 3, 1 };
+  for (int count : counts) {
+    double avg0 = conv->readAverage (0, false, count);
+    double avg1 = conv->readAverage (1, false, count);
+
+    std::cout << "count = " << count << " > AIN0: " << avg0 << ", AIN1: " << avg1 << " (Digital)" << std::endl;
+    CHECK_CLOSE (D1Int, avg0, digitalErr);
+    CHECK_CLOSE (D2Int, avg1, digitalErr);
+  }
+  CHECK_CLOSE (V1, conv->readAverageValue (0, false, 16), absErr);
+
+  // Invalid parameters
+  CHECK_EQUAL (Converter::InvalidValue, conv->readAverage (0, false, 0));
+  CHECK_EQUAL (Converter::InvalidValue, conv->readAverage (conv->numberOfChannels()));
+  end();
+}
+
+// -----------------------------------------------------------------------------
+static void streamHandler (const Converter::Sample *samples, int count, void *userData) {
+  int *calls = static_cast<int *> (userData);
+
+  if (count == 2 && samples[0].channel == 0 && samples[1].channel == 1) {
+    (*calls)++;
+  }
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (ConverterFixture, Test8) {
+  const double absErr = 0.05; // Absolute error tolerance for voltage readings
+  const double rate = 200; // Scan rate in Hz
+  std::vector<Converter::Sample> samples (1024);
+  int calls = 0;
+
+  begin (8, "Max1161x Background Acquisition tests");
+
+  // acquisition of AIN0 and AIN1 started by open()
+  conv.reset (Converter::factory ("max1161x:ref=int:rate=200:scan=0-1"));
+  CHECK (conv != nullptr);
+  conv->setDebug (true);
+
+  std::cout << "Check the voltage on AIN0, it should be 2V ± " << absErr << "V" << std::endl;
+  std::cout << "Check the voltage on AIN1, it should be 1V ± " << absErr << "V" << std::endl;
+
+  CHECK_EQUAL (false, conv->isAcquiring());
+  CHECK_EQUAL (-1, conv->readStream (samples.data(), samples.size()));
+  conv->attachStreamHandler (streamHandler, &calls);
+  CHECK_EQUAL (true, conv->open());
+  CHECK_EQUAL (true, conv->isAcquiring());
+  CHECK_CLOSE (rate, conv->acquisitionRate(), 0.001);
+
+  long digitalErr = conv->valueToDigital (absErr);  // Convert absolute error to digital value
+
+  clk.delay (500);
+  int n = conv->readStream (samples.data(), samples.size());
+  Converter::AcquisitionStats stats = conv->acquisitionStats();
+
+  std::cout << "samples: " << n << ", scans: " << stats.scans << ", overruns: " << stats.overruns
+            << ", missed: " << stats.missed << ", errors: " << stats.errors
+            << ", jitter: " << stats.meanJitter << "/" << stats.maxJitter << " ns" << std::endl;
+
+  CHECK (n >= 2 * 90 && n <= 2 * 110); // 100 scans of 2 channels in 500 ms
+  CHECK_EQUAL (0, n % 2);
+  CHECK_EQUAL (0UL, stats.overruns);
+  CHECK_EQUAL (0UL, stats.errors);
+  CHECK (calls >= 90);
+  for (int i = 0; i < n; i += 2) {
+
+    CHECK_EQUAL (0, samples[i].channel);
+    CHECK_EQUAL (1, samples[i + 1].channel);
+    CHECK_EQUAL (samples[i].timestamp, samples[i + 1].timestamp);
+    CHECK_CLOSE (D1Int, samples[i].value, digitalErr);
+    CHECK_CLOSE (D2Int, samples[i + 1].value, digitalErr);
+    if (i > 0) {
+      // the period is 5 ms
+      CHECK_CLOSE (5000000, samples[i].timestamp - samples[i - 2].timestamp, 1000000);
+    }
+  }
+
+  // synchronous reads are still possible while acquiring
+  CHECK_CLOSE (D1Int, conv->readChannel (0), digitalErr);
+
+  conv->stopAcquisition();
+  CHECK_EQUAL (false, conv->isAcquiring());
+  conv->detachStreamHandler();
+
+  // invalid parameters
+  CHECK_EQUAL (false, conv->startAcquisition (0));
+  CHECK_EQUAL (false, conv->startAcquisition (rate, 1, 0));
+  CHECK_EQUAL (false, conv->startAcquisition (rate, 0, conv->numberOfChannels()));
+
+  // restart on a single channel
+  CHECK_EQUAL (true, conv->startAcquisition (rate, 0));
+  CHECK_EQUAL (false, conv->startAcquisition (rate, 1)); // already running
+  clk.delay (100);
+  conv->close();
+  CHECK_EQUAL (false, conv->isAcquiring());
+  n = conv->readStream (samples.data(), samples.size());
+  CHECK (n > 0);
+  CHECK_EQUAL (0, samples[n - 1].channel);
+
+  // invalid acquisition options are rejected, the converter is still created
+  conv.reset (Converter::factory ("max1161x:ref=int:rate=fast:scan=a-b"));
+  CHECK (conv != nullptr);
+  CHECK_EQUAL (true, conv->open());
+  CHECK_EQUAL (false, conv->isAcquiring());
+  conv->close();
+  end();
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (ConverterFixture, Test9) {
+  const double absErr = 0.05; // Absolute error tolerance for voltage readings
+  std::vector<long> block (100);
+
+  begin (9, "Max1161x Block Read tests");
+
+  conv = std::make_unique<Max1161x>();
+  CHECK (conv != nullptr);
+  conv->setDebug (true);
+
+  std::cout << "Check the voltage on AIN0, it should be 2V ± " << absErr << "V" << std::endl;
+  std::cout << "Check the voltage on AIN1, it should be 1V ± " << absErr << "V" << std::endl;
+
+  conv->setReference (Max1161x::InternalReference);
+  CHECK_EQUAL (true, conv->open());
+
+  long digitalErr = conv->valueToDigital (absErr);  // Convert absolute error to digital value
+
+  // 100 samples, each one is a new conversion with the internal clock
+  CHECK_EQUAL (true, conv->readBlock (0, block.data(), block.size()));
+  for (long v : block) {
+    CHECK_CLOSE (D1Int, v, digitalErr);
+  }
+  // the noise of the last bits differs from one conversion to the next, a block
+  // of identical samples is the result of a single conversion read again
+  CHECK (std::adjacent_find (block.begin(), block.end(), std::not_equal_to<long>()) != block.end());
+  CHECK_EQUAL (true, conv->readBlock (1, block.data(), 5));
+  for (int i = 0; i < 5; i++) {
+    CHECK_CLOSE (D2Int, block[i], digitalErr);
+  }
+
+  // Invalid parameters
+  CHECK_EQUAL (false, conv->readBlock (0, block.data(), 0));
+  CHECK_EQUAL (false, conv->readBlock (0, nullptr, 1));
+  CHECK_EQUAL (false, conv->readBlock (conv->numberOfChannels(), block.data(), 1));
+  end();
+}
+
+// -----------------------------------------------------------------------------
+TEST_FIXTURE (TestFixture, Test10) {
+  const long digital[] = { 0, 1, 1000, 2047, 4095 };
+  const double analog[] = { -1.0, 0.0, 0.5, 1.0, 2.047, 5.0 };
+  const size_t nd = sizeof (digital) / sizeof (digital[0]);
+  const size_t na = sizeof (analog) / sizeof (analog[0]);
+  double values[nd];
+  long digitals[na];
+
+  begin (10, "Max1161x array conversion tests");
+
+  Max1161x conv ("max1161x:ref=int:fsr=2.048");
+
+  // same results as the scalar conversions
+  conv.digitalToValue (digital, values, nd, 0);
+  for (size_t i = 0; i < nd; i++) {
+    CHECK_EQUAL (conv.digitalToValue (0, digital[i]), values[i]);
+  }
+  conv.valueToDigital (analog, digitals, na, 0);
+  for (size_t i = 0; i < na; i++) {
+    CHECK_EQUAL (conv.valueToDigital (0, analog[i]), digitals[i]);
+  }
+  CHECK_EQUAL (0, digitals[0]); // clamped to min()
+  CHECK_EQUAL (4095, digitals[na - 1]); // clamped to max()
+
+  // the cached scaling follows the setters
+  CHECK_EQUAL (true, conv.setReference (Max1161x::ExternalReference, 2.5));
+  conv.digitalToValue (digital, values, nd, 0);
+  CHECK_CLOSE (2.5 * 4095 / 4096, values[nd - 1], 1e-9);
+
+  CHECK_EQUAL (true, conv.setBipolar (true));
+  conv.valueToDigital (analog, digitals, na, 0, true);
+  for (size_t i = 0; i < na; i++) {
+    CHECK_EQUAL (conv.valueToDigital (0, analog[i], true), digitals[i]);
+  }
+  CHECK_EQUAL (-2048, digitals[0]);
+  CHECK_EQUAL (2047, digitals[na - 1]);
+  end();
+}
+
 // run all tests
 int main (int argc, char **argv) {
 
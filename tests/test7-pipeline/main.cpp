@@ -0,0 +1,202 @@
+// Pipeline Unit Test
+// Use UnitTest++ framework -> https://github.com/unittest-cpp/unittest-cpp/wiki
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+#include <piduino/pipeline.h>
+
+#include <UnitTest++/UnitTest++.h>
+
+using namespace std;
+using namespace Piduino;
+
+// processes a block of one channel and returns the output samples
+static vector<double> process (Pipeline::Stage &stage, vector<double> in) {
+  size_t n = stage.process (0, in.data(), in.size());
+
+  in.resize (n);
+  return in;
+}
+
+TEST (Test1) {
+  cout << "Test1: Stage factory" << endl;
+  const char *valid[] = { "avg:n=8", "lowpass:fc=10", "decim:n=4", "min:n=2", "max:n=2", "mean:n=2", "rms:n=2" };
+  const char *invalid[] = { "avg", "avg:n=0", "lowpass:fc=0", "median:n=3", "decim:n=x", "" };
+
+  for (auto spec : valid) {
+    unique_ptr<Pipeline::Stage> stage (Pipeline::stageFactory (spec));
+    CHECK (stage != nullptr);
+  }
+  for (auto spec : invalid) {
+    unique_ptr<Pipeline::Stage> stage (Pipeline::stageFactory (spec));
+    CHECK (stage == nullptr);
+  }
+}
+
+TEST (Test2) {
+  cout << "Test2: MovingAverage" << endl;
+  Pipeline::MovingAverage avg (4);
+
+  avg.prepare (1, 1000);
+  vector<double> out = process (avg, {4, 8, 0, 4});
+  CHECK_EQUAL (4U, out.size());
+  CHECK_CLOSE (4.0, out[0], 1e-12);
+  CHECK_CLOSE (6.0, out[1], 1e-12);
+  CHECK_CLOSE (4.0, out[2], 1e-12);
+  CHECK_CLOSE (4.0, out[3], 1e-12);
+
+  // the window slides across the blocks
+  out = process (avg, {8, 8});
+  CHECK_CLOSE (5.0, out[0], 1e-12);
+  CHECK_CLOSE (5.0, out[1], 1e-12);
+}
+
+TEST (Test3) {
+  cout << "Test3: LowPass" << endl;
+  const double fc = 10;
+  const double rate = 1000;
+  Pipeline::LowPass lp (fc);
+
+  lp.prepare (2, rate);
+  // a constant signal passes without change
+  vector<double> out = process (lp, vector<double> (100, 1.5));
+  for (double v : out) {
+    CHECK_CLOSE (1.5, v, 1e-12);
+  }
+
+  // step response of the channel 1, 1 - (1 - alpha)^n
+  const double rc = 1 / (2 * M_PI * fc);
+  const double alpha = (1 / rate) / (rc + 1 / rate);
+  vector<double> step (1000, 1.0);
+  step[0] = 0;
+  lp.process (1, step.data(), step.size());
+  CHECK_CLOSE (alpha, step[1], 1e-12);
+  CHECK_CLOSE (1 - pow (1 - alpha, 16), step[16], 1e-12);
+  CHECK_CLOSE (1.0, step.back(), 1e-6);
+}
+
+TEST (Test4) {
+  cout << "Test4: Decimator" << endl;
+  Pipeline::Decimator dec (3);
+  vector<double> in;
+
+  dec.prepare (1, 900);
+  CHECK_CLOSE (300.0, dec.outputRate (900), 1e-12);
+  for (int i = 0; i < 10; i++) {
+    in.push_back (i);
+  }
+  vector<double> out = process (dec, in);
+  CHECK_EQUAL (4U, out.size());
+  CHECK_EQUAL (0.0, out[0]);
+  CHECK_EQUAL (9.0, out[3]);
+
+  // the phase is kept between the blocks: 10, 11 dropped, 12 kept
+  out = process (dec, {10, 11, 12});
+  CHECK_EQUAL (1U, out.size());
+  CHECK_EQUAL (12.0, out[0]);
+}
+
+TEST (Test5) {
+  cout << "Test5: Window" << endl;
+  const vector<double> in = {1, -3, 2, 5, 0, -1};
+  Pipeline::Window wmin (Pipeline::Window::Min, 3);
+  Pipeline::Window wmax (Pipeline::Window::Max, 3);
+  Pipeline::Window wmean (Pipeline::Window::Mean, 3);
+  Pipeline::Window wrms (Pipeline::Window::Rms, 2);
+
+  wmin.prepare (1, 1000);
+  wmax.prepare (1, 1000);
+  wmean.prepare (1, 1000);
+  wrms.prepare (1, 1000);
+
+  vector<double> out = process (wmin, in);
+  CHECK_EQUAL (2U, out.size());
+  CHECK_EQUAL (-3.0, out[0]);
+  CHECK_EQUAL (-1.0, out[1]);
+
+  out = process (wmax, in);
+  CHECK_EQUAL (2.0, out[0]);
+  CHECK_EQUAL (5.0, out[1]);
+
+  out = process (wmean, in);
+  CHECK_CLOSE (0.0, out[0], 1e-12);
+  CHECK_CLOSE (4.0 / 3, out[1], 1e-12);
+
+  out = process (wrms, {3, 4, 1});
+  CHECK_EQUAL (1U, out.size());
+  CHECK_CLOSE (sqrt (12.5), out[0], 1e-12);
+  // the third sample is kept for the next window
+  out = process (wrms, {1});
+  CHECK_EQUAL (1U, out.size());
+  CHECK_CLOSE (1.0, out[0], 1e-12);
+}
+
+TEST (Test6) {
+  cout << "Test6: RingSink" << endl;
+  unique_ptr<Pipeline::Sink> sink (Pipeline::sinkFactory ("ring:size=4"));
+  Pipeline::RingSink *ring = dynamic_cast<Pipeline::RingSink *> (sink.get());
+  double ch0[] = {1, 2, 3, 4, 5};
+  double ch1[] = {10, 20, 30, 40, 50};
+  const double *data[] = {ch0, ch1};
+  double frames[10];
+
+  REQUIRE CHECK (ring != nullptr);
+  CHECK (ring->prepare (0, 2, 1000, 5));
+  CHECK (ring->write (data, 3));
+  CHECK_EQUAL (3U, ring->available());
+  CHECK_EQUAL (2U, ring->read (frames, 2));
+  CHECK_EQUAL (1.0, frames[0]);
+  CHECK_EQUAL (10.0, frames[1]);
+  CHECK_EQUAL (2.0, frames[2]);
+  CHECK_EQUAL (20.0, frames[3]);
+
+  // 1 frame left, 3 free: the last 2 of 5 frames are dropped
+  CHECK_EQUAL (false, ring->write (data, 5));
+  CHECK_EQUAL (2UL, ring->overruns());
+  CHECK_EQUAL (4U, ring->read (frames, 5));
+  CHECK_EQUAL (3.0, frames[0]);
+  CHECK_EQUAL (30.0, frames[1]);
+  CHECK_EQUAL (3.0, frames[6]);
+}
+
+TEST (Test7) {
+  cout << "Test7: FileSink" << endl;
+  const string path = "/tmp/piduino-test7-pipeline.csv";
+  double ch0[] = {1.5, 2};
+  double ch1[] = {-1, 0.25};
+  const double *data[] = {ch0, ch1};
+  {
+    unique_ptr<Pipeline::Sink> sink (Pipeline::sinkFactory ("csv:file=" + path));
+
+    REQUIRE CHECK (sink != nullptr);
+    CHECK (sink->prepare (2, 2, 100, 2));
+    CHECK (sink->write (data, 2));
+    sink->flush();
+  }
+
+  FILE *f = fopen (path.c_str(), "r");
+  char line[64];
+  REQUIRE CHECK (f != nullptr);
+  CHECK (fgets (line, sizeof (line), f) != nullptr);
+  CHECK_EQUAL ("ch2,ch3\n", string (line));
+  CHECK (fgets (line, sizeof (line), f) != nullptr);
+  CHECK_EQUAL ("1.5,-1\n", string (line));
+  CHECK (fgets (line, sizeof (line), f) != nullptr);
+  CHECK_EQUAL ("2,0.25\n", string (line));
+  fclose (f);
+  remove (path.c_str());
+
+  unique_ptr<Pipeline::Sink> missing (Pipeline::sinkFactory ("csv"));
+  CHECK (missing == nullptr);
+}
+
+// run all tests
+int main (int argc, char **argv) {
+
+  return UnitTest::RunAllTests();
+}
+
+/* ========================================================================== */
@@ -0,0 +1,119 @@
+// ByteRing Unit Test
+// Use UnitTest++ framework -> https://github.com/unittest-cpp/unittest-cpp/wiki
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+#include <piduino/bytering.h>
+
+#include <UnitTest++/UnitTest++.h>
+
+using namespace std;
+using namespace Piduino;
+
+TEST (Test1) {
+  cout << "Test1: write and read" << endl;
+  ByteRing ring (8);
+  char buf[8];
+
+  CHECK_EQUAL (8U, ring.capacity());
+  CHECK_EQUAL (5U, ring.write ("hello", 5));
+  CHECK_EQUAL (5U, ring.size());
+  CHECK_EQUAL (3U, ring.peek (buf, 3));
+  CHECK_EQUAL ("hel", string (buf, 3));
+  CHECK_EQUAL (5U, ring.size());
+  CHECK_EQUAL (5U, ring.read (buf, sizeof (buf)));
+  CHECK_EQUAL ("hello", string (buf, 5));
+  CHECK_EQUAL (0U, ring.size());
+  CHECK_EQUAL (0U, ring.read (buf, sizeof (buf)));
+}
+
+TEST (Test2) {
+  cout << "Test2: wrap around" << endl;
+  ByteRing ring (8);
+  char buf[8];
+  string str;
+
+  ring.write ("abcdef", 6);
+  CHECK_EQUAL (4U, ring.read (buf, 4));
+  // 2 bytes at the end of the array, 4 at the beginning
+  CHECK_EQUAL (6U, ring.write ("ghijkl", 6));
+  CHECK_EQUAL (8U, ring.peek (str));
+  CHECK_EQUAL ("efghijkl", str);
+  CHECK_EQUAL (8U, ring.read (buf, sizeof (buf)));
+  CHECK_EQUAL ("efghijkl", string (buf, 8));
+}
+
+TEST (Test3) {
+  cout << "Test3: overruns" << endl;
+  ByteRing ring (4);
+  string str;
+
+  CHECK_EQUAL (4U, ring.write ("123456", 6));
+  CHECK_EQUAL (2UL, ring.overruns());
+  CHECK (!ring.write ('7'));
+  CHECK_EQUAL (3UL, ring.overruns());
+  CHECK_EQUAL (4U, ring.read (str));
+  CHECK_EQUAL ("1234", str);
+  ring.clear();
+  CHECK_EQUAL (0UL, ring.overruns());
+}
+
+TEST (Test4) {
+  cout << "Test4: blocking read" << endl;
+  ByteRing ring (16);
+  char c = 0;
+
+  // timeout without data
+  auto t0 = chrono::steady_clock::now();
+  CHECK (!ring.read (c, 20));
+  CHECK (chrono::steady_clock::now() - t0 >= chrono::milliseconds (20));
+
+  thread writer ([&ring] {
+    this_thread::sleep_for (chrono::milliseconds (10));
+    ring.write ('x');
+  });
+  CHECK (ring.read (c, -1));
+  CHECK_EQUAL ('x', c);
+  writer.join();
+}
+
+TEST (Test5) {
+  cout << "Test5: regions and views" << endl;
+  ByteRing ring (8);
+  char *region;
+
+  CHECK_EQUAL (8U, ring.writeRegion (region));
+  memcpy (region, "abcdef", 6);
+  ring.commit (6);
+  ring.consume (4);
+
+  // free region up to the end of the array, then at its beginning
+  CHECK_EQUAL (2U, ring.writeRegion (region));
+  memcpy (region, "gh", 2);
+  ring.commit (2);
+  CHECK_EQUAL (4U, ring.writeRegion (region));
+  memcpy (region, "ijkl", 4);
+  ring.commit (4);
+  CHECK_EQUAL (0U, ring.writeRegion (region));
+
+  ByteRing::Views v = ring.views();
+  CHECK_EQUAL (8U, v.total());
+  CHECK_EQUAL ("efgh", string (v.data[0], v.size[0]));
+  CHECK_EQUAL ("ijkl", string (v.data[1], v.size[1]));
+  ring.consume (5);
+  v = ring.views();
+  CHECK_EQUAL (3U, v.total());
+  CHECK_EQUAL ("jkl", string (v.data[0], v.size[0]));
+  CHECK_EQUAL (0U, v.size[1]);
+}
+
+// run all tests
+int main (int argc, char **argv) {
+
+  return UnitTest::RunAllTests();
+}
+
+/* ========================================================================== */
@@ -0,0 +1,114 @@
+// TerminalNotifier Unit Test
+// Use UnitTest++ framework -> https://github.com/unittest-cpp/unittest-cpp/wiki
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <pty.h>
+#include <unistd.h>
+
+#include <piduino/terminalnotifier.h>
+
+#include <UnitTest++/UnitTest++.h>
+
+using namespace std;
+using namespace Piduino;
+
+// pseudo terminal, the notifier reads the slave side
+struct Pty {
+  Pty() : master (-1), slave (-1) {
+    openpty (&master, &slave, nullptr, nullptr, nullptr);
+  }
+  ~Pty() {
+    ::close (master);
+    ::close (slave);
+  }
+  void send (const string &str) {
+    CHECK_EQUAL ( (ssize_t) str.size(), ::write (master, str.data(), str.size()));
+  }
+  int master;
+  int slave;
+};
+
+TEST (Test1) {
+  cout << "Test1: receive buffer" << endl;
+  Pty pty;
+  FileDevice dev (pty.slave);
+  TerminalNotifier notifier (&dev);
+  string str;
+
+  CHECK (notifier.start());
+  CHECK_EQUAL (0, notifier.lastReceived());
+  pty.send ("hello");
+  CHECK_EQUAL (5U, notifier.peek (str, 500));
+  this_thread::sleep_for (chrono::milliseconds (10));
+  CHECK_EQUAL (5U, notifier.read (str));
+  CHECK_EQUAL ("hello", str);
+  CHECK (notifier.lastReceived() > 0);
+  notifier.terminate();
+  CHECK (!notifier.isRunning());
+}
+
+TEST (Test2) {
+  cout << "Test2: frames separated by silences" << endl;
+  Pty pty;
+  FileDevice dev (pty.slave);
+  TerminalNotifier notifier (&dev);
+  TerminalNotifier::Frame frame;
+
+  notifier.setFrameGap (20000);
+  CHECK (notifier.start());
+  pty.send ("abc");
+  this_thread::sleep_for (chrono::milliseconds (2));
+  pty.send ("def");
+  this_thread::sleep_for (chrono::milliseconds (50));
+  pty.send ("XY");
+
+  CHECK (notifier.readFrame (frame, 500));
+  CHECK_EQUAL ("abcdef", frame.data);
+  CHECK (frame.end >= frame.begin);
+  CHECK (notifier.readFrame (frame, 500));
+  CHECK_EQUAL ("XY", frame.data);
+  CHECK (!notifier.readFrame (frame));
+  CHECK_EQUAL (0U, notifier.available());
+  notifier.terminate();
+}
+
+TEST (Test3) {
+  cout << "Test3: frame handler" << endl;
+  Pty pty;
+  FileDevice dev (pty.slave);
+  TerminalNotifier notifier (&dev);
+  std::mutex mutex;
+  std::vector<string> received;
+
+  notifier.setFrameGap (10000);
+  notifier.setFrameHandler ([&] (const TerminalNotifier::Frame & f) {
+    std::lock_guard<std::mutex> lock (mutex);
+    received.push_back (f.data);
+  });
+  CHECK (notifier.start());
+  pty.send ("frame1");
+  this_thread::sleep_for (chrono::milliseconds (50));
+  pty.send ("frame2");
+  this_thread::sleep_for (chrono::milliseconds (50));
+  notifier.terminate();
+
+  std::lock_guard<std::mutex> lock (mutex);
+  CHECK_EQUAL (2U, received.size());
+  if (received.size() == 2) {
+    CHECK_EQUAL ("frame1", received[0]);
+    CHECK_EQUAL ("frame2", received[1]);
+  }
+  CHECK_EQUAL (0U, notifier.framesAvailable());
+}
+
+// run all tests
+int main (int argc, char **argv) {
+
+  return UnitTest::RunAllTests();
+}
+
+/* ========================================================================== */